@@ -0,0 +1,229 @@
+// host capacity benchmark: how many concurrent games one core can tick in
+// real time.
+//
+// every frame (1 / tick_hz of wall-clock time) each hosted game gets its
+// synthetic play stream and one updateMomentum step; the thread then sleeps
+// until the next frame boundary. the game count ramps geometrically, each
+// configuration runs for a fixed number of seconds, and the ramp stops at
+// the first configuration whose frame work overruns the tick deadline.
+// with degrade set, each game gets its share of the time left in the frame
+// as a tick deadline and sheds optional crowd / noise / history work.
+//
+// usage: capacity_bench [seed] [seconds_per_step] [max_games] [tick_hz] [degrade]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "crowd_momentum_system.h"
+#include "memory_accounting.h"
+#include "simulated_game.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedUs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// one hosted game and its synthetic play stream, in frames
+struct HostedGame {
+    SimulatedGame game;
+    int frame_index = 0;
+    int next_snap = 0;
+};
+
+struct StepResult {
+    std::size_t games;
+    long frames;
+    long missed;
+    double tick_p50_us;
+    double tick_p99_us;
+    double tick_p999_us;
+    double frame_p99_ms;
+    double frame_max_ms;
+    double degraded_percent;
+};
+
+// nearest-rank percentile; sorts in place
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<long>(rank), samples.end());
+    return samples[rank];
+}
+
+class CapacityBench {
+private:
+    std::mt19937 rng;
+    int tick_hz;
+    bool degrade;
+    std::vector<std::unique_ptr<HostedGame>> games;
+
+    // same play cadence as the PGO training game: a snap every 20-30 s,
+    // one in five of them a burst of 3-6 plays
+    int nextSnapGap() {
+        return std::uniform_int_distribution<int>(20 * tick_hz, 30 * tick_hz)(rng);
+    }
+
+    void tickGame(HostedGame& hosted, float frame) {
+        if (hosted.frame_index == hosted.next_snap) {
+            const int plays = (rng() % 5 == 0) ? std::uniform_int_distribution<int>(3, 6)(rng) : 1;
+            for (int p = 0; p < plays; p++) {
+                hosted.game.playRandomEvent(rng);
+            }
+            hosted.next_snap += nextSnapGap();
+        }
+        hosted.game.system.updateMomentum(frame);
+        if (hosted.frame_index % tick_hz == 0) {
+            hosted.game.state.updateTime(1);
+        }
+        hosted.frame_index++;
+    }
+
+public:
+    CapacityBench(unsigned seed, int tickHz, bool degradeUnderLoad)
+        : rng(seed),
+          tick_hz(tickHz),
+          degrade(degradeUnderLoad) {
+    }
+
+    void hostGames(std::size_t count) {
+        while (games.size() < count) {
+            auto hosted = std::make_unique<HostedGame>();
+            // stagger the streams so snaps do not line up across games
+            hosted->next_snap = std::uniform_int_distribution<int>(0, 30 * tick_hz)(rng);
+            games.push_back(std::move(hosted));
+        }
+    }
+
+    // ticks run in full and ticks run in total, over all hosted games
+    void countTicks(std::uint64_t& full, std::uint64_t& all) const {
+        full = 0;
+        all = 0;
+        for (const auto& hosted : games) {
+            const TickScheduler& scheduler = hosted->game.system.getScheduler();
+            full += scheduler.getTickCount(TickDegradation::FULL);
+            for (std::size_t level = 0; level < kTickDegradationCount; level++) {
+                all += scheduler.getTickCount(static_cast<TickDegradation>(level));
+            }
+        }
+    }
+
+    StepResult run(double seconds) {
+        const float frame = 1.0f / static_cast<float>(tick_hz);
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frame));
+        const double deadline_us = 1e6 / tick_hz;
+        const long frames = std::max(1L, static_cast<long>(seconds * tick_hz));
+
+        std::vector<double> ticks;
+        std::vector<double> frame_times;
+        ticks.reserve(static_cast<std::size_t>(frames) * games.size());
+        frame_times.reserve(static_cast<std::size_t>(frames));
+        long missed = 0;
+        std::uint64_t full_before;
+        std::uint64_t all_before;
+        countTicks(full_before, all_before);
+
+        auto frame_start = Clock::now();
+        for (long f = 0; f < frames; f++) {
+            const auto frame_end = frame_start + period;
+            auto tick_start = frame_start;
+            std::size_t games_left = games.size();
+            for (auto& hosted : games) {
+                if (degrade) {
+                    // an even share of what is left of the frame
+                    const auto share = tick_start < frame_end ? (frame_end - tick_start) / static_cast<long>(games_left)
+                                                              : Clock::duration::zero();
+                    hosted->game.system.setTickDeadline(tick_start + share);
+                }
+                games_left--;
+                tickGame(*hosted, frame);
+                const auto tick_end = Clock::now();
+                ticks.push_back(elapsedUs(tick_start, tick_end));
+                tick_start = tick_end;
+            }
+            const double frame_us = elapsedUs(frame_start, tick_start);
+            frame_times.push_back(frame_us);
+            if (frame_us > deadline_us) {
+                missed++;
+            }
+
+            // real-time pacing; an overrun frame starts the next one late
+            frame_start += period;
+            const auto now = Clock::now();
+            if (frame_start > now) {
+                std::this_thread::sleep_until(frame_start);
+            } else {
+                frame_start = now;
+            }
+        }
+
+        StepResult result;
+        result.games = games.size();
+        result.frames = frames;
+        result.missed = missed;
+        result.tick_p50_us = percentile(ticks, 0.5);
+        result.tick_p99_us = percentile(ticks, 0.99);
+        result.tick_p999_us = percentile(ticks, 0.999);
+        result.frame_p99_ms = percentile(frame_times, 0.99) / 1000.0;
+        result.frame_max_ms = *std::max_element(frame_times.begin(), frame_times.end()) / 1000.0;
+
+        std::uint64_t full;
+        std::uint64_t all;
+        countTicks(full, all);
+        full -= full_before;
+        all -= all_before;
+        result.degraded_percent = all > 0 ? 100.0 * static_cast<double>(all - full) / static_cast<double>(all) : 0.0;
+        return result;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 7u;
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    const std::size_t max_games = argc > 3 ? static_cast<std::size_t>(std::atol(argv[3])) : 65536;
+    const int tick_hz = argc > 4 ? std::max(1, std::atoi(argv[4])) : 30;
+    const bool degrade = argc > 5 && std::atoi(argv[5]) != 0;
+
+    std::printf("tick %d Hz (deadline %.3f ms), %.1f s per step, up to %zu games%s\n",
+                tick_hz, 1000.0 / tick_hz, seconds, max_games, degrade ? ", degrading under load" : "");
+    std::printf("%8s %8s %8s %12s %12s %12s %12s %12s %10s %14s\n", "games", "frames", "missed",
+                "tick p50 us", "tick p99 us", "tick p999 us", "frame p99 ms", "frame max ms", "degraded",
+                "bytes / game");
+
+    CapacityBench bench(seed, tick_hz, degrade);
+    std::size_t sustainable = 0;
+    for (std::size_t games = 1; games <= max_games; games = std::max(games + 1, games * 3 / 2)) {
+        bench.hostGames(games);
+        const StepResult r = bench.run(seconds);
+
+        std::size_t live_bytes = 0;
+        for (std::size_t tag = 0; tag < kMemoryTagCount; tag++) {
+            live_bytes += MemoryAccounting::getStats(static_cast<MemoryTag>(tag)).live_bytes;
+        }
+        std::printf("%8zu %8ld %8ld %12.2f %12.2f %12.2f %12.3f %12.3f %9.1f%% %14zu\n", r.games, r.frames,
+                    r.missed, r.tick_p50_us, r.tick_p99_us, r.tick_p999_us, r.frame_p99_ms, r.frame_max_ms,
+                    r.degraded_percent, live_bytes / r.games);
+        std::fflush(stdout);
+        if (r.missed > 0) {
+            break;
+        }
+        sustainable = r.games;
+    }
+
+    std::printf("max sustainable games %zu\n", sustainable);
+    MemoryAccounting::dump(stdout);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// canned workload used both to train PGO builds and to benchmark them:
+// a full simulated game with event bursts followed by an inventory
+// trading session. prints one "<phase> <milliseconds>" line per phase;
+// the checksum and per-subsystem memory counters go to stderr.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "crowd_momentum_system.h"
+#include "inventory.h"
+#include "memory_accounting.h"
+#include "simulated_game.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// four quarters at 30 Hz; a snap every ~25 s and now and then a burst of
+// big plays, with every snap asking for the modifiers of all 22 players
+double simulateGame(std::mt19937& rng, GameRecording& recording, double& checksum) {
+    SimulatedGame game;
+    game.system.attachRecording(&recording);
+
+    std::vector<Player*> on_field;
+    for (int i = 0; i < 11; i++) {
+        on_field.push_back(game.home.getPlayers()[i]);
+        on_field.push_back(game.away.getPlayers()[i]);
+    }
+    std::vector<ModifierQuery> queries;
+    for (Player* player : on_field) {
+        queries.push_back(game.system.makeModifierQuery(*player, EffectType::ACCURACY_BOOST));
+        queries.push_back(game.system.makeModifierQuery(*player, EffectType::SNAP_TIMING_PENALTY));
+    }
+    std::vector<float> modifiers;
+
+    const float frame = 1.0f / 30.0f;
+    std::uniform_int_distribution<int> snap_gap(20 * 30, 30 * 30);
+    std::uniform_int_distribution<int> burst_size(3, 6);
+    int next_snap = snap_gap(rng);
+
+    auto start = Clock::now();
+    for (int frame_index = 0; frame_index < 4 * 15 * 60 * 30; frame_index++) {
+        if (frame_index == next_snap) {
+            const int plays = (rng() % 5 == 0) ? burst_size(rng) : 1;
+            for (int p = 0; p < plays; p++) {
+                game.playRandomEvent(rng);
+            }
+            game.system.queryModifiers(queries, modifiers);
+            checksum += modifiers[0];
+            next_snap += snap_gap(rng);
+        }
+        game.system.updateMomentum(frame);
+        if (frame_index % 30 == 0) {
+            game.state.updateTime(1);
+        }
+    }
+    recording.setDuration(game.system.getElapsedTime());
+    checksum += game.system.getMomentumMeter()->getMomentumDifference();
+    return elapsedMs(start);
+}
+
+double sweepWhatIf(const GameRecording& recording, double& checksum) {
+    std::vector<MomentumParams> variants(64);
+    for (std::size_t i = 0; i < variants.size(); i++) {
+        variants[i].decay_rate = 0.02f + 0.005f * static_cast<float>(i);
+    }
+    MomentumWhatIfEngine engine(1.0f / 30.0f);
+    auto start = Clock::now();
+    std::vector<MomentumCurve> curves = engine.runVariants(recording, variants);
+    const double ms = elapsedMs(start);
+    checksum += curves.back().home_momentum.back();
+    return ms;
+}
+
+// a store session: mostly sales of stocked items, some misses, restocks
+double tradeInventory(std::mt19937& rng, double& checksum) {
+    Inventory inventory;
+    const int stocked = 5000;
+    for (int i = 0; i < stocked; i++) {
+        inventory.add_item("item-" + std::to_string(i), 20, 1.0f + static_cast<float>(i % 50));
+    }
+
+    std::uniform_int_distribution<int> pick(0, stocked - 1);
+    std::uniform_int_distribution<int> amount(1, 3);
+    auto start = Clock::now();
+    for (int op = 0; op < 200000; op++) {
+        const int roll = static_cast<int>(rng() % 10);
+        const std::string name = "item-" + std::to_string(pick(rng));
+        if (roll < 7) {
+            if (inventory.sell(name, amount(rng)) == SaleStatus::SOLD_OUT) {
+                inventory.add_item(name, 20, 5.0f);
+            }
+        } else if (roll < 9) {
+            inventory.sell("missing-" + name, 1);
+        } else {
+            inventory.add_item(name + "-new", 5, 2.5f);
+        }
+    }
+    checksum += inventory.get_total_money() + static_cast<double>(inventory.item_count());
+    return elapsedMs(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 42u;
+    std::mt19937 rng(seed);
+    double checksum = 0.0;
+
+    auto start = Clock::now();
+    GameRecording recording;
+    const double game_ms = simulateGame(rng, recording, checksum);
+    const double what_if_ms = sweepWhatIf(recording, checksum);
+    const double inventory_ms = tradeInventory(rng, checksum);
+    const double total_ms = elapsedMs(start);
+
+    std::printf("game_simulation %.3f\n", game_ms);
+    std::printf("what_if_sweep %.3f\n", what_if_ms);
+    std::printf("inventory_session %.3f\n", inventory_ms);
+    std::printf("total %.3f\n", total_ms);
+    std::fprintf(stderr, "checksum %.6f\n", checksum);
+    MemoryAccounting::dump(stderr);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef SIMULATED_GAME_H
+#define SIMULATED_GAME_H
+
+#include <memory>
+#include <random>
+#include <string>
+
+#include "crowd_momentum_system.h"
+
+/**
+ * one complete game for benchmarks and training runs: two full rosters,
+ * a stadium crowd and an initialized CrowdMomentumSystem
+ */
+struct SimulatedGame {
+    Team home;
+    Team away;
+    Stadium stadium;
+    GameState state;
+    CrowdMomentumSystem system;
+
+    explicit SimulatedGame(int stadiumCapacity = 100000, int rosterSize = 53)
+        : home("home", "Home", true),
+          away("away", "Away", false),
+          stadium("stadium", "Stadium", stadiumCapacity, VenueType::LARGE_STADIUM),
+          state(&home, &away),
+          system(&state, &stadium) {
+        static const Position kPositions[] = {
+            Position::QUARTERBACK, Position::RUNNING_BACK, Position::WIDE_RECEIVER,
+            Position::TIGHT_END, Position::OFFENSIVE_LINE, Position::DEFENSIVE_LINE,
+            Position::LINEBACKER, Position::CORNERBACK, Position::SAFETY, Position::KICKER
+        };
+        for (int i = 0; i < rosterSize; i++) {
+            Position position = kPositions[i % 10];
+            home.addPlayer(std::make_unique<Player>("h" + std::to_string(i), "Home " + std::to_string(i),
+                                                    &home, position));
+            away.addPlayer(std::make_unique<Player>("a" + std::to_string(i), "Away " + std::to_string(i),
+                                                    &away, position));
+        }
+        home.setCoach(std::make_unique<Coach>("hc", "Home Coach", &home, 80));
+        away.setCoach(std::make_unique<Coach>("ac", "Away Coach", &away, 70));
+        stadium.initializeCrowd(&home, &away);
+        system.initialize();
+    }
+
+    // a random play: mostly routine, sometimes a big momentum swing
+    void playRandomEvent(std::mt19937& rng) {
+        static const EventType kEvents[] = {
+            EventType::TOUCHDOWN, EventType::INTERCEPTION, EventType::SACK,
+            EventType::FOURTH_DOWN_STOP, EventType::FUMBLE, EventType::FIELD_GOAL,
+            EventType::PENALTY, EventType::SAFETY, EventType::TURNOVER
+        };
+        std::uniform_int_distribution<int> pick(0, 8);
+        Team* team = (rng() & 1) != 0 ? &home : &away;
+        GameEvent event(kEvents[pick(rng)], team);
+        event.calculateMomentumImpact(state);
+        system.processGameEvent(event);
+    }
+};
+
+#endif
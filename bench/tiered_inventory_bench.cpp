@@ -0,0 +1,125 @@
+// memory and sale cost of TieredInventory against a plain Inventory.
+//
+// stocks the same items in both, then reports tracked bytes per item (from
+// the memory accounting, so only tagged allocations count) and the cost of
+// a sale of a hot item, a sale of a name that is not stocked, and, for the
+// tiered inventory, the first sale of a cold item, which promotes it. the
+// same sales go to both, and every stock line must agree afterwards.
+//
+// usage: tiered_inventory_bench [items] [hot_capacity] [seed]
+// exit status: 0 when both inventories agree, 1 otherwise
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inventory.h"
+#include "memory_accounting.h"
+#include "tiered_inventory.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::size_t liveBytes() {
+    std::size_t bytes = 0;
+    for (std::size_t tag = 0; tag < kMemoryTagCount; tag++) {
+        bytes += MemoryAccounting::getStats(static_cast<MemoryTag>(tag)).live_bytes;
+    }
+    return bytes;
+}
+
+// best of three passes, in ns per sale
+template <typename Sell>
+double timeSales(const std::vector<std::string>& names, Sell&& sell) {
+    double best = 0;
+    for (int pass = 0; pass < 3; pass++) {
+        const auto start = Clock::now();
+        for (const std::string& name : names) {
+            sell(name);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+                          static_cast<double>(names.size());
+        best = pass == 0 ? ns : std::min(best, ns);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t items = argc > 1 ? static_cast<std::size_t>(std::max(1L, std::atol(argv[1]))) : 200000;
+    const std::size_t hot_capacity = argc > 2 ? static_cast<std::size_t>(std::max(1L, std::atol(argv[2]))) : 4096;
+    const unsigned seed = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 1u;
+
+    std::mt19937 rng(seed);
+    std::vector<std::string> names;
+    std::vector<float> prices;
+    for (std::size_t i = 0; i < items; i++) {
+        names.push_back("sku-" + std::to_string(i));
+        prices.push_back(static_cast<float>(rng() % 100 + 1));
+    }
+    // the most recently added items are the ones the tiered inventory keeps hot
+    const std::size_t working = std::min(items, hot_capacity / 2);
+    std::vector<std::string> hot_names(names.end() - static_cast<long>(working), names.end());
+    std::shuffle(hot_names.begin(), hot_names.end(), rng);
+    std::vector<std::string> missing;
+    for (std::size_t i = 0; i < working; i++) {
+        missing.push_back("missing-" + std::to_string(i));
+    }
+    std::vector<std::string> cold_names(names.begin(), names.begin() + static_cast<long>(std::min(items - working, working)));
+    std::shuffle(cold_names.begin(), cold_names.end(), rng);
+
+    std::printf("%zu items, hot capacity %zu\n", items, hot_capacity);
+    std::printf("%-10s %14s %14s %14s %16s\n", "inventory", "bytes / item", "hot sale ns", "miss sale ns",
+                "cold sale ns");
+
+    std::size_t base = liveBytes();
+    Inventory plain;
+    for (std::size_t i = 0; i < items; i++) {
+        plain.add_item(names[i], 1000, prices[i]);
+    }
+    const double plain_bytes = static_cast<double>(liveBytes() - base) / static_cast<double>(items);
+    const double plain_hot = timeSales(hot_names, [&](const std::string& name) { plain.sell(name, 1); });
+    const double plain_miss = timeSales(missing, [&](const std::string& name) { plain.sell(name, 1); });
+    for (const std::string& name : cold_names) {
+        plain.sell(name, 1);
+    }
+    std::printf("%-10s %14.1f %14.1f %14.1f %16s\n", "plain", plain_bytes, plain_hot, plain_miss, "-");
+
+    base = liveBytes();
+    TieredInventory tiered(hot_capacity);
+    for (std::size_t i = 0; i < items; i++) {
+        tiered.add_item(names[i], 1000, prices[i]);
+    }
+    const double tiered_bytes = static_cast<double>(liveBytes() - base) / static_cast<double>(items);
+    const double tiered_hot = timeSales(hot_names, [&](const std::string& name) { tiered.sell(name, 1); });
+    const double tiered_miss = timeSales(missing, [&](const std::string& name) { tiered.sell(name, 1); });
+    // each cold item is promoted by its first sale, so this runs once
+    const auto start = Clock::now();
+    for (const std::string& name : cold_names) {
+        tiered.sell(name, 1);
+    }
+    const double tiered_cold = std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+                               static_cast<double>(std::max<std::size_t>(1, cold_names.size()));
+    std::printf("%-10s %14.1f %14.1f %14.1f %16.1f\n", "tiered", tiered_bytes, tiered_hot, tiered_miss,
+                tiered_cold);
+    std::printf("tiered: %zu hot, %zu cold\n", tiered.hot_count(), tiered.cold_count());
+
+    std::size_t mismatches = 0;
+    for (const std::string& name : names) {
+        const std::size_t index = plain.find_item(name);
+        const int quantity = index == Inventory::npos ? 0 : plain.get_items()[index].get_quantity();
+        mismatches += tiered.get_quantity(name) != quantity ? 1 : 0;
+    }
+    if (mismatches > 0 || plain.get_total_money() != tiered.get_total_money()) {
+        std::printf("FAILED: %zu stock lines differ, money %.2f / %.2f\n", mismatches, plain.get_total_money(),
+                    tiered.get_total_money());
+        return 1;
+    }
+    return 0;
+}
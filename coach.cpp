@@ -0,0 +1,62 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+Coach::Coach(const std::string& id, const std::string& name, Team* team, int leadership)
+    : coach_id(makeTaggedName(id)),
+      coach_name(makeTaggedName(name)),
+      team(team),
+      leadership_rating(std::min(100, std::max(0, leadership))),
+      composure_cooldown(120.0f),
+      cooldown_remaining(0.0f),
+      can_use_composure(true) {
+}
+
+bool Coach::canActivateComposure() const {
+    return can_use_composure && cooldown_remaining <= 0.0f && team != nullptr;
+}
+
+void Coach::activateTeamComposure() {
+    if (!canActivateComposure()) {
+        return;
+    }
+    team->activateComposureMode();
+    cooldown_remaining = composure_cooldown;
+}
+
+void Coach::updateCooldown(float delta_time) {
+    cooldown_remaining = std::max(0.0f, cooldown_remaining - delta_time);
+}
+
+void Coach::resetCooldown() {
+    cooldown_remaining = 0.0f;
+}
+
+float Coach::getLeadershipBonus() const {
+    // up to +50% for a 100-rated leader
+    return static_cast<float>(leadership_rating) / 200.0f;
+}
+
+int Coach::getLeadershipRating() const {
+    return leadership_rating;
+}
+
+Team* Coach::getTeam() const {
+    return team;
+}
+
+std::string Coach::getName() const {
+    return toString(coach_name);
+}
+
+float Coach::getCooldownRemaining() const {
+    return cooldown_remaining;
+}
+
+void Coach::setLeadershipRating(int rating) {
+    leadership_rating = std::min(100, std::max(0, rating));
+}
+
+void Coach::setCooldownTime(float cooldown) {
+    composure_cooldown = cooldown;
+}
@@ -0,0 +1,258 @@
+#ifndef COLD_ITEM_STORE_H
+#define COLD_ITEM_STORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "inventory_digest.h"
+#include "memory_accounting.h"
+#include "name_filter.h"
+
+// one stock line as the cold tier keeps it
+struct ColdRecord {
+    std::string name;
+    int quantity;
+    float price;
+
+    bool operator<(const ColdRecord &other) const {
+        return name < other.name;
+    }
+};
+
+// compact store for rarely touched stock lines.
+//
+// records are kept sorted by name in blocks of up to kMaxBlockRecords, and
+// each block is one byte string: per record the length of the prefix it
+// shares with the previous name, the rest of the name, the quantity as
+// varints, and the price. sorted names share long prefixes ("sku-10231",
+// "sku-10232"), so a typical record takes around ten bytes instead of a
+// full Item. only the first name of each block is kept uncompressed, to
+// find the one block a lookup has to decode.
+//
+// a counting bloom filter over the names, at 8 counters (4 bytes) per
+// record, turns most lookups of names that are not here away before any
+// block is decoded.
+class ColdItemStore {
+private:
+    static constexpr size_t kMaxBlockRecords = 64;
+    static constexpr size_t kFilterCountersPerName = 8;
+
+    struct Block {
+        TaggedName first_name;
+        size_t record_count;
+        TaggedVector<uint8_t, MemoryTag::INVENTORY_ITEMS> data;
+    };
+
+    TaggedVector<Block, MemoryTag::INVENTORY_ITEMS> blocks;
+    size_t record_count;
+    NameFilter name_filter;
+
+    static uint64_t hash_of(const std::string &name) {
+        return InventoryDigest::hash_name(name.data(), name.size());
+    }
+
+    // regrows the filter once it holds more names than it was sized for,
+    // re-adding every name from the blocks
+    void fit_filter() {
+        if (record_count <= name_filter.get_capacity()) {
+            return;
+        }
+        name_filter.reset(2 * record_count);
+        for (const Block &block : blocks) {
+            for (const ColdRecord &record : decode(block)) {
+                name_filter.add(hash_of(record.name));
+            }
+        }
+    }
+
+    static void put_varint(TaggedVector<uint8_t, MemoryTag::INVENTORY_ITEMS> &out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t get_varint(const uint8_t *&in) {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *in++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+    }
+
+    static Block encode(const ColdRecord *records, size_t count) {
+        Block block{makeTaggedName(records[0].name), count, {}};
+        const std::string *previous = nullptr;
+        for (size_t i = 0; i < count; i++) {
+            const ColdRecord &record = records[i];
+            size_t shared = 0;
+            if (previous != nullptr) {
+                size_t limit = std::min(previous->size(), record.name.size());
+                while (shared < limit && (*previous)[shared] == record.name[shared]) {
+                    shared++;
+                }
+            }
+            put_varint(block.data, static_cast<uint32_t>(shared));
+            put_varint(block.data, static_cast<uint32_t>(record.name.size() - shared));
+            block.data.insert(block.data.end(), record.name.begin() + static_cast<long>(shared), record.name.end());
+            put_varint(block.data, static_cast<uint32_t>(record.quantity));
+            uint8_t price[sizeof(float)];
+            std::memcpy(price, &record.price, sizeof(float));
+            block.data.insert(block.data.end(), price, price + sizeof(float));
+            previous = &record.name;
+        }
+        block.data.shrink_to_fit();
+        return block;
+    }
+
+    static std::vector<ColdRecord> decode(const Block &block) {
+        std::vector<ColdRecord> records(block.record_count);
+        const uint8_t *in = block.data.data();
+        for (size_t i = 0; i < block.record_count; i++) {
+            ColdRecord &record = records[i];
+            size_t shared = get_varint(in);
+            size_t suffix = get_varint(in);
+            if (i > 0) {
+                record.name.assign(records[i - 1].name, 0, shared);
+            }
+            record.name.append(reinterpret_cast<const char *>(in), suffix);
+            in += suffix;
+            record.quantity = static_cast<int>(get_varint(in));
+            std::memcpy(&record.price, in, sizeof(float));
+            in += sizeof(float);
+        }
+        return records;
+    }
+
+    // the block a name belongs in: the last one starting at or before it
+    size_t block_for(const std::string &name) const {
+        auto after = std::upper_bound(blocks.begin(), blocks.end(), name,
+                                      [](const std::string &n, const Block &block) {
+                                          return n.compare(0, std::string::npos, block.first_name.data(),
+                                                           block.first_name.size()) < 0;
+                                      });
+        return after == blocks.begin() ? 0 : static_cast<size_t>(after - blocks.begin()) - 1;
+    }
+
+    // replaces block b with the records, split into as many blocks as needed
+    void rewrite(size_t b, const std::vector<ColdRecord> &records) {
+        blocks.erase(blocks.begin() + static_cast<long>(b));
+        size_t pieces = (records.size() + kMaxBlockRecords - 1) / kMaxBlockRecords;
+        for (size_t p = 0; p < pieces; p++) {
+            // even pieces, so a split does not leave a one-record block
+            size_t begin = records.size() * p / pieces;
+            size_t end = records.size() * (p + 1) / pieces;
+            blocks.insert(blocks.begin() + static_cast<long>(b + p), encode(&records[begin], end - begin));
+        }
+    }
+
+public:
+    ColdItemStore() :
+            blocks{},
+            record_count{0},
+            name_filter{64, kFilterCountersPerName} {
+
+    }
+
+    // adds a batch of records, decoding and re-encoding each block it
+    // touches once
+    void insert(std::vector<ColdRecord> records) {
+        if (records.empty()) {
+            return;
+        }
+        std::stable_sort(records.begin(), records.end());
+        record_count += records.size();
+        if (record_count <= name_filter.get_capacity()) {
+            for (const ColdRecord &record : records) {
+                name_filter.add(hash_of(record.name));
+            }
+        }
+        if (blocks.empty()) {
+            blocks.emplace_back();
+            rewrite(0, records);
+            fit_filter();
+            return;
+        }
+        size_t next = 0;
+        while (next < records.size()) {
+            size_t b = block_for(records[next].name);
+            // this block takes every record up to the start of the next one
+            size_t end = next + 1;
+            while (end < records.size() &&
+                   (b + 1 == blocks.size() || records[end].name.compare(0, std::string::npos,
+                                                                        blocks[b + 1].first_name.data(),
+                                                                        blocks[b + 1].first_name.size()) < 0)) {
+                end++;
+            }
+            std::vector<ColdRecord> merged = decode(blocks[b]);
+            size_t middle = merged.size();
+            merged.insert(merged.end(), records.begin() + static_cast<long>(next),
+                          records.begin() + static_cast<long>(end));
+            std::inplace_merge(merged.begin(), merged.begin() + static_cast<long>(middle), merged.end());
+            rewrite(b, merged);
+            next = end;
+        }
+        fit_filter();
+    }
+
+    // removes and returns the first record with this name
+    bool take(const std::string &name, ColdRecord *record) {
+        const uint64_t name_hash = hash_of(name);
+        if (blocks.empty() || !name_filter.may_contain(name_hash)) {
+            return false;
+        }
+        size_t b = block_for(name);
+        std::vector<ColdRecord> records = decode(blocks[b]);
+        auto found = std::lower_bound(records.begin(), records.end(), ColdRecord{name, 0, 0});
+        if (found == records.end() || found->name != name) {
+            return false;
+        }
+        if (record != nullptr) {
+            *record = *found;
+        }
+        records.erase(found);
+        record_count--;
+        name_filter.remove(name_hash);
+        if (records.empty()) {
+            blocks.erase(blocks.begin() + static_cast<long>(b));
+        } else {
+            rewrite(b, records);
+        }
+        return true;
+    }
+
+    // looks a record up without taking it out
+    bool find(const std::string &name, ColdRecord *record) const {
+        if (blocks.empty() || !name_filter.may_contain(hash_of(name))) {
+            return false;
+        }
+        std::vector<ColdRecord> records = decode(blocks[block_for(name)]);
+        auto found = std::lower_bound(records.begin(), records.end(), ColdRecord{name, 0, 0});
+        if (found == records.end() || found->name != name) {
+            return false;
+        }
+        if (record != nullptr) {
+            *record = *found;
+        }
+        return true;
+    }
+
+    size_t size() const {
+        return record_count;
+    }
+
+    size_t block_count() const {
+        return blocks.size();
+    }
+};
+
+#endif
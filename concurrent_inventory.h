@@ -0,0 +1,377 @@
+#ifndef CONCURRENT_INVENTORY_H
+#define CONCURRENT_INVENTORY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "inventory.h"
+#include "memory_accounting.h"
+
+// inventory shared by many checkout threads, selling bundles atomically.
+//
+// every item carries a version word: even while the item is free, odd while
+// a transaction holds it. a bundle reads the versions and quantities of its
+// items without locking, validates them, then claims each item by swapping
+// its version from the value it read to the odd one. if any claim fails,
+// someone changed that item in between: the claims are undone and the
+// bundle backs off and starts over. a failed bundle reports its status only
+// after rereading the versions, so it never fails on a torn read.
+//
+// sales take no lock: names are found through an insert-only hash table
+// published with an atomic pointer, and the money is kept in per-item
+// stripes. bundles over disjoint items share no written word other than a
+// money stripe, and two items share a stripe only every kMoneyStripes adds.
+// only add_item takes a mutex, against other adds.
+//
+// statuses match Inventory: a sale that empties an item returns SOLD_OUT
+// (a bundle returns SOLD, as Inventory::sell_bundle does), and the item then
+// reads as NOT_FOUND until it is added again. unlike Inventory, adding a
+// name that is in stock restocks it at the new price instead of adding a
+// second stock line.
+class ConcurrentInventory {
+private:
+    static constexpr size_t kMoneyStripes = 16;
+
+    struct Slot {
+        TaggedName name;
+        uint64_t name_hash;
+        size_t stripe;
+        std::atomic<uint64_t> version;
+        std::atomic<int> quantity;      // 0 once sold out, until restocked
+        std::atomic<float> price;
+
+        Slot(const std::string &name, uint64_t name_hash, size_t stripe, int quantity, float price) :
+                name{makeTaggedName(name)},
+                name_hash{name_hash},
+                stripe{stripe},
+                version{0},
+                quantity{quantity},
+                price{price} {
+
+        }
+    };
+
+    // insert-only open addressing, so a lookup never sees a slot move
+    struct NameTable {
+        TaggedVector<std::atomic<Slot *>, MemoryTag::INVENTORY_ITEMS> buckets;
+
+        explicit NameTable(size_t size) :
+                buckets(size) {
+            for (std::atomic<Slot *> &bucket : buckets) {
+                bucket.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct alignas(64) MoneyStripe {
+        std::atomic<float> money{0};
+    };
+
+    struct Claim {
+        Slot *slot;
+        int quantity;
+        uint64_t version;
+        int seen_quantity;
+        float seen_price;
+    };
+
+    mutable std::mutex add_mutex;
+    std::deque<Slot, TaggedAllocator<Slot, MemoryTag::INVENTORY_ITEMS>> slots;  // stable addresses
+    // every table ever published stays allocated: a lookup may still be
+    // probing an older one
+    std::vector<std::unique_ptr<NameTable>> tables;
+    std::atomic<NameTable *> names;
+    MoneyStripe money[kMoneyStripes];
+
+    Slot *find_slot(const std::string &name) const {
+        const uint64_t name_hash = InventoryDigest::hash_name(name.data(), name.size());
+        const NameTable *table = names.load(std::memory_order_acquire);
+        const size_t mask = table->buckets.size() - 1;
+        for (size_t bucket = static_cast<size_t>(name_hash) & mask;; bucket = (bucket + 1) & mask) {
+            Slot *slot = table->buckets[bucket].load(std::memory_order_acquire);
+            if (slot == nullptr) {
+                return nullptr;
+            }
+            if (slot->name_hash == name_hash && slot->name.size() == name.size() &&
+                std::memcmp(slot->name.data(), name.data(), name.size()) == 0) {
+                return slot;
+            }
+        }
+    }
+
+    // add_mutex held
+    static void place(NameTable &table, Slot *slot) {
+        const size_t mask = table.buckets.size() - 1;
+        size_t bucket = static_cast<size_t>(slot->name_hash) & mask;
+        while (table.buckets[bucket].load(std::memory_order_relaxed) != nullptr) {
+            bucket = (bucket + 1) & mask;
+        }
+        table.buckets[bucket].store(slot, std::memory_order_release);
+    }
+
+    // add_mutex held; keeps the table at most half full
+    void reserve_name() {
+        NameTable *table = names.load(std::memory_order_relaxed);
+        if ((slots.size() + 1) * 2 <= table->buckets.size()) {
+            return;
+        }
+        tables.push_back(std::make_unique<NameTable>(2 * table->buckets.size()));
+        NameTable *grown = tables.back().get();
+        for (Slot &slot : slots) {
+            place(*grown, &slot);
+        }
+        names.store(grown, std::memory_order_release);
+    }
+
+    void credit(size_t stripe, float amount) {
+        std::atomic<float> &total = money[stripe].money;
+        float current = total.load(std::memory_order_relaxed);
+        while (!total.compare_exchange_weak(current, current + amount, std::memory_order_relaxed)) {
+        }
+    }
+
+    // spins a little longer after each failed attempt, then yields
+    static void back_off(unsigned attempt) {
+        if (attempt >= 8) {
+            std::this_thread::yield();
+            return;
+        }
+        for (unsigned i = 0; i < (1u << attempt); i++) {
+#if defined(__SSE2__)
+            _mm_pause();
+#endif
+        }
+    }
+
+    static void release(std::vector<Claim> &claims, size_t claimed, bool applied) {
+        // an applied transaction publishes a new even version, an abandoned
+        // one restores the version it found
+        for (size_t i = 0; i < claimed; i++) {
+            claims[i].slot->version.store(claims[i].version + (applied ? 2 : 0), std::memory_order_release);
+        }
+    }
+
+    // reads of a failed attempt count only if no version moved since
+    static bool unchanged(const std::vector<Claim> &claims) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        for (const Claim &claim : claims) {
+            if (claim.slot->version.load(std::memory_order_relaxed) != claim.version) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // single is Inventory::sell's check order (a missing item before a bad
+    // quantity) and its SOLD_OUT; otherwise Inventory::sell_bundle's
+    SaleStatus run(const std::vector<BundleLine> &lines, bool single, float *money_earned, size_t *failed_line) {
+        constexpr size_t none = SIZE_MAX;
+        std::vector<Claim> claims;
+        claims.reserve(lines.size());
+        std::vector<size_t> claim_of_line(lines.size(), none);
+        for (size_t i = 0; i < lines.size(); i++) {
+            Slot *slot = find_slot(lines[i].name);
+            if (slot == nullptr) {
+                continue;
+            }
+            // the same item twice in a bundle is one claim for the sum
+            auto same = std::find_if(claims.begin(), claims.end(), [&](const Claim &c) { return c.slot == slot; });
+            if (same == claims.end()) {
+                claims.push_back({slot, 0, 0, 0, 0});
+                same = claims.end() - 1;
+            }
+            claim_of_line[i] = static_cast<size_t>(same - claims.begin());
+        }
+        // claimed in address order, so two overlapping bundles contend on
+        // their first shared item instead of each holding half
+        std::vector<size_t> order(claims.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return claims[a].slot < claims[b].slot; });
+        std::vector<int> wanted(claims.size());
+
+        for (unsigned attempt = 0;; attempt++) {
+            if (attempt > 0) {
+                back_off(attempt - 1);
+            }
+
+            // optimistic read, no item is held yet
+            bool busy = false;
+            for (Claim &claim : claims) {
+                claim.version = claim.slot->version.load(std::memory_order_acquire);
+                if ((claim.version & 1) != 0) {
+                    busy = true;
+                    break;
+                }
+                claim.seen_quantity = claim.slot->quantity.load(std::memory_order_relaxed);
+                claim.seen_price = claim.slot->price.load(std::memory_order_relaxed);
+            }
+            if (busy) {
+                continue;
+            }
+
+            // the lines in order, checked as Inventory checks them
+            std::fill(wanted.begin(), wanted.end(), 0);
+            SaleStatus status = SaleStatus::SOLD;
+            size_t failed = 0;
+            for (size_t i = 0; i < lines.size() && status == SaleStatus::SOLD; i++) {
+                const size_t c = claim_of_line[i];
+                const bool missing = c == none || claims[c].seen_quantity == 0;
+                const bool invalid = lines[i].quantity <= 0;
+                if (single ? missing : invalid) {
+                    status = single ? SaleStatus::NOT_FOUND : SaleStatus::INVALID_QUANTITY;
+                } else if (single ? invalid : missing) {
+                    status = single ? SaleStatus::INVALID_QUANTITY : SaleStatus::NOT_FOUND;
+                } else if (lines[i].quantity > claims[c].seen_quantity - wanted[c]) {
+                    // against what the earlier lines left, so the sum cannot wrap
+                    status = SaleStatus::INSUFFICIENT_QUANTITY;
+                } else {
+                    wanted[c] += lines[i].quantity;
+                }
+                failed = i;
+            }
+            if (status != SaleStatus::SOLD) {
+                if (!unchanged(claims)) {
+                    continue;
+                }
+                if (failed_line != nullptr) {
+                    *failed_line = failed;
+                }
+                return status;
+            }
+            for (size_t c = 0; c < claims.size(); c++) {
+                claims[c].quantity = wanted[c];
+            }
+
+            // claim phase: any version that moved since the read aborts
+            std::vector<Claim> sorted;
+            sorted.reserve(claims.size());
+            for (size_t i : order) {
+                sorted.push_back(claims[i]);
+            }
+            size_t claimed = 0;
+            for (; claimed < sorted.size(); claimed++) {
+                uint64_t expected = sorted[claimed].version;
+                if (!sorted[claimed].slot->version.compare_exchange_strong(expected, expected + 1,
+                                                                           std::memory_order_acquire)) {
+                    break;
+                }
+            }
+            if (claimed < sorted.size()) {
+                release(sorted, claimed, false);
+                continue;
+            }
+
+            // every version is unchanged, so the validated reads hold
+            float earned = 0;
+            bool sold_out = false;
+            for (const Claim &claim : sorted) {
+                const float line_money = claim.seen_price * static_cast<float>(claim.quantity);
+                claim.slot->quantity.store(claim.seen_quantity - claim.quantity, std::memory_order_relaxed);
+                credit(claim.slot->stripe, line_money);
+                earned += line_money;
+                sold_out = sold_out || claim.seen_quantity == claim.quantity;
+            }
+            release(sorted, sorted.size(), true);
+            if (money_earned != nullptr) {
+                *money_earned = earned;
+            }
+            return single && sold_out ? SaleStatus::SOLD_OUT : SaleStatus::SOLD;
+        }
+    }
+
+public:
+    ConcurrentInventory() :
+            add_mutex{},
+            slots{},
+            tables{},
+            names{nullptr},
+            money{} {
+        tables.push_back(std::make_unique<NameTable>(64));
+        names.store(tables.back().get(), std::memory_order_release);
+    }
+
+    ConcurrentInventory(const ConcurrentInventory &) = delete;
+    ConcurrentInventory &operator=(const ConcurrentInventory &) = delete;
+
+    // adds a new item, or restocks an existing one at the new price
+    bool add_item(const std::string &name, int quantity, float price) {
+        if (quantity <= 0 || !(price >= 0)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(add_mutex);
+        Slot *slot = find_slot(name);
+        if (slot == nullptr) {
+            reserve_name();
+            const uint64_t name_hash = InventoryDigest::hash_name(name.data(), name.size());
+            slots.emplace_back(name, name_hash, slots.size() % kMoneyStripes, quantity, price);
+            place(*names.load(std::memory_order_relaxed), &slots.back());
+            return true;
+        }
+
+        // a restock is a one-item transaction against the bundles in flight
+        uint64_t version = slot->version.load(std::memory_order_relaxed);
+        for (unsigned attempt = 0;
+             (version & 1) != 0 || !slot->version.compare_exchange_weak(version, version + 1, std::memory_order_acquire);
+             attempt++) {
+            back_off(attempt);
+            version = slot->version.load(std::memory_order_relaxed);
+        }
+        slot->quantity.fetch_add(quantity, std::memory_order_relaxed);
+        slot->price.store(price, std::memory_order_relaxed);
+        slot->version.store(version + 2, std::memory_order_release);
+        return true;
+    }
+
+    // sells every line or none. on failure failed_line names the line that
+    // could not be satisfied
+    SaleStatus sell_bundle(const std::vector<BundleLine> &lines, float *money_earned = nullptr,
+                           size_t *failed_line = nullptr) {
+        return run(lines, false, money_earned, failed_line);
+    }
+
+    SaleStatus sell(const std::string &name, int quantity, float *money_earned = nullptr) {
+        return run({{name, quantity}}, true, money_earned, nullptr);
+    }
+
+    // 0 for a name that is not in stock
+    int get_quantity(const std::string &name) const {
+        const Slot *slot = find_slot(name);
+        return slot == nullptr ? 0 : slot->quantity.load(std::memory_order_relaxed);
+    }
+
+    // items in stock
+    size_t item_count() const {
+        std::lock_guard<std::mutex> lock(add_mutex);
+        size_t count = 0;
+        for (const Slot &slot : slots) {
+            count += slot.quantity.load(std::memory_order_relaxed) > 0 ? 1 : 0;
+        }
+        return count;
+    }
+
+    // the sum of the money stripes; exact once no sale is in flight
+    float get_total_money() const {
+        float total = 0;
+        for (const MoneyStripe &stripe : money) {
+            total += stripe.money.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+#endif
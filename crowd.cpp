@@ -0,0 +1,242 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+namespace {
+
+float clampEnthusiasm(float value) {
+    return std::min(100.0f, std::max(0.0f, value));
+}
+
+// same noise a CrowdSection reports for this attendance and enthusiasm
+float sectionNoise(int attendance, float enthusiasm) {
+    return static_cast<float>(attendance) * (0.2f + 0.8f * enthusiasm / 100.0f);
+}
+
+} // namespace
+
+Crowd::Crowd(Stadium* stadium, int num_sections)
+    : noise_level(60.0f),
+      enthusiasm(50.0f),
+      stadium(stadium),
+      base_noise_level(60.0f),
+      max_noise_level(120.0f),
+      seat_count(0),
+      sections_stale(false),
+      contagion_rate(0.2f),
+      event_bus(nullptr),
+      noise_peak_level(110.0f),
+      noise_peaking(false) {
+    // unaffiliated sections until the stadium assigns teams
+    const int capacity = stadium != nullptr ? stadium->getCapacity() : 0;
+    for (int i = 0; i < num_sections; i++) {
+        addCrowdSection(nullptr, num_sections > 0 ? capacity / num_sections : 0);
+    }
+}
+
+Crowd::~Crowd() {
+}
+
+void Crowd::pushToSections() {
+    if (!sections_stale) {
+        return;
+    }
+    for (std::size_t i = 0; i < crowd_sections.size(); i++) {
+        crowd_sections[i]->setEnthusiasm(section_enthusiasm[i]);
+    }
+    sections_stale = false;
+}
+
+void Crowd::pullFromSections() {
+    for (std::size_t i = 0; i < crowd_sections.size(); i++) {
+        section_enthusiasm[i] = crowd_sections[i]->getEnthusiasm();
+    }
+}
+
+void Crowd::reactToEvent(const GameEvent& event) {
+    pushToSections();
+    for (auto& section : crowd_sections) {
+        section->reactToPlay(event);
+    }
+    pullFromSections();
+    updateEnthusiasm(0.0f);
+    generateNoise();
+}
+
+void Crowd::generateNoise() {
+    float noise = 0.0f;
+    for (std::size_t i = 0; i < section_enthusiasm.size(); i++) {
+        noise += sectionNoise(section_attendance[i], section_enthusiasm[i]);
+    }
+
+    const float fill = seat_count > 0 ? noise / static_cast<float>(seat_count) : 0.0f;
+    const float venue = stadium != nullptr ? stadium->getVenueBonus() : 1.0f;
+    noise_level = std::min(max_noise_level,
+                           base_noise_level + (max_noise_level - base_noise_level) * fill * venue);
+
+    // rising edge only, re-armed once the crowd settles a little
+    if (!noise_peaking && noise_level >= noise_peak_level) {
+        noise_peaking = true;
+        if (event_bus != nullptr) {
+            event_bus->publishNoisePeak(noise_level);
+        }
+    } else if (noise_peaking && noise_level < noise_peak_level - 5.0f) {
+        noise_peaking = false;
+    }
+}
+
+void Crowd::updateEnthusiasm(float adjustment) {
+    // the crowd's enthusiasm is the attendance-weighted mean of its sections
+    float weighted = 0.0f;
+    long long attendance = 0;
+    for (std::size_t i = 0; i < section_enthusiasm.size(); i++) {
+        if (adjustment != 0.0f) {
+            section_enthusiasm[i] = clampEnthusiasm(section_enthusiasm[i] + adjustment);
+        }
+        weighted += section_enthusiasm[i] * static_cast<float>(section_attendance[i]);
+        attendance += section_attendance[i];
+    }
+    sections_stale = sections_stale || adjustment != 0.0f;
+    enthusiasm = clampEnthusiasm(attendance > 0 ? weighted / static_cast<float>(attendance)
+                                                : enthusiasm + adjustment);
+}
+
+void Crowd::resetCrowd() {
+    std::fill(section_enthusiasm.begin(), section_enthusiasm.end(), 50.0f);
+    sections_stale = true;
+    enthusiasm = 50.0f;
+    noise_level = base_noise_level;
+    noise_peaking = false;
+}
+
+void Crowd::spreadEnthusiasm(float delta_time) {
+    if (contagion_rate <= 0.0f || crowd_sections.size() < 2) {
+        return;
+    }
+    if (contagion_graph.getSectionCount() != crowd_sections.size()) {
+        rebuildContagionGraph();
+    }
+
+    // the step is a convex mix, so the clamp only absorbs rounding
+    contagion_graph.diffuse(section_enthusiasm.data(), contagion_rate, delta_time);
+    for (float& value : section_enthusiasm) {
+        value = clampEnthusiasm(value);
+    }
+    sections_stale = true;
+    updateEnthusiasm(0.0f);
+}
+
+float Crowd::getVolumeLevel() const {
+    const float range = max_noise_level - base_noise_level;
+    return range > 0.0f ? std::max(0.0f, (noise_level - base_noise_level) / range) : 0.0f;
+}
+
+bool Crowd::isQuiet() const {
+    return getVolumeLevel() < 0.25f;
+}
+
+bool Crowd::isLoud() const {
+    return getVolumeLevel() > 0.75f;
+}
+
+std::size_t Crowd::getSectionCount() const {
+    return crowd_sections.size();
+}
+
+void Crowd::setBaseNoiseLevel(float level) {
+    base_noise_level = level;
+}
+
+void Crowd::setMaxNoiseLevel(float level) {
+    max_noise_level = level;
+}
+
+void Crowd::addCrowdSection(Team* team, int capacity) {
+    const std::string id = "section-" + std::to_string(crowd_sections.size() + 1);
+    crowd_sections.push_back(std::make_unique<CrowdSection>(id, team, capacity));
+    section_enthusiasm.push_back(crowd_sections.back()->getEnthusiasm());
+    section_attendance.push_back(crowd_sections.back()->getCurrentAttendance());
+    seat_count += crowd_sections.back()->getCapacity();
+}
+
+void Crowd::setContagionRate(float rate) {
+    contagion_rate = std::max(0.0f, rate);
+}
+
+float Crowd::getContagionRate() const {
+    return contagion_rate;
+}
+
+void Crowd::rebuildContagionGraph(int tiers) {
+    contagion_graph = CrowdContagionGraph::stadiumBowl(crowd_sections.size(),
+                                                       static_cast<std::size_t>(std::max(1, tiers)));
+}
+
+void Crowd::setEventBus(MomentumEventBus* bus) {
+    event_bus = bus;
+}
+
+MomentumEventBus* Crowd::getEventBus() const {
+    return event_bus;
+}
+
+void Crowd::setNoisePeakLevel(float level) {
+    noise_peak_level = level;
+}
+
+CrowdSection::CrowdSection(const std::string& id, Team* team, int capacity)
+    : section_id(makeTaggedName(id)),
+      team_affiliation(team),
+      capacity(std::max(0, capacity)),
+      current_attendance(std::max(0, capacity)),
+      current_enthusiasm(50.0f),
+      noise_contribution(0.0f) {
+    setEnthusiasm(current_enthusiasm);
+}
+
+void CrowdSection::cheer(float intensity) {
+    setEnthusiasm(current_enthusiasm + 10.0f * intensity);
+}
+
+void CrowdSection::boo(float intensity) {
+    setEnthusiasm(current_enthusiasm - 8.0f * intensity);
+}
+
+void CrowdSection::reactToPlay(const GameEvent& event) {
+    if (team_affiliation == nullptr || event.getTeam() == nullptr) {
+        return;
+    }
+    // a good play for your team is cheered; a good play for the other team
+    // (or your own team's penalty) deflates the section
+    const float impact = event.getMomentumImpact();
+    const float intensity = (impact < 0.0f ? -impact : impact) / 10.0f;
+    const bool own_team = event.getTeam() == team_affiliation;
+    if (own_team == (impact >= 0.0f)) {
+        cheer(intensity);
+    } else {
+        boo(intensity);
+    }
+}
+
+Team* CrowdSection::getTeamAffiliation() const {
+    return team_affiliation;
+}
+
+int CrowdSection::getCapacity() const {
+    return capacity;
+}
+
+int CrowdSection::getCurrentAttendance() const {
+    return current_attendance;
+}
+
+void CrowdSection::setAttendance(int attendance) {
+    current_attendance = std::max(0, std::min(attendance, capacity));
+    setEnthusiasm(current_enthusiasm);
+}
+
+void CrowdSection::setEnthusiasm(float newEnthusiasm) {
+    current_enthusiasm = clampEnthusiasm(newEnthusiasm);
+    // even a flat crowd makes some noise
+    noise_contribution = sectionNoise(current_attendance, current_enthusiasm);
+}
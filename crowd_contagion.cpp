@@ -0,0 +1,164 @@
+#include "crowd_contagion.h"
+
+#include <algorithm>
+
+CrowdContagionGraph::CrowdContagionGraph(std::size_t sections)
+    : section_count(0),
+      max_weight_sum(0.0f) {
+    reset(sections);
+}
+
+void CrowdContagionGraph::reset(std::size_t sections) {
+    section_count = sections;
+    pending_edges.clear();
+    row_offsets.assign(sections + 1, 0);
+    column_indices.clear();
+    weights.clear();
+    weight_sums.assign(sections, 0.0f);
+    max_weight_sum = 0.0f;
+    neighbour_sum.assign(sections, 0.0f);
+}
+
+void CrowdContagionGraph::addAdjacency(std::uint32_t a, std::uint32_t b, float weight) {
+    if (a == b || a >= section_count || b >= section_count || weight <= 0.0f) {
+        return;
+    }
+    pending_edges.push_back({std::min(a, b), std::max(a, b), weight});
+}
+
+void CrowdContagionGraph::build() {
+    // one edge per pair, the weight added last winning
+    std::stable_sort(pending_edges.begin(), pending_edges.end(),
+                     [](const PendingEdge& x, const PendingEdge& y) {
+                         return x.from != y.from ? x.from < y.from : x.to < y.to;
+                     });
+    std::size_t unique = 0;
+    for (std::size_t i = 0; i < pending_edges.size(); i++) {
+        if (unique > 0 && pending_edges[unique - 1].from == pending_edges[i].from &&
+            pending_edges[unique - 1].to == pending_edges[i].to) {
+            pending_edges[unique - 1].weight = pending_edges[i].weight;
+        } else {
+            pending_edges[unique++] = pending_edges[i];
+        }
+    }
+    pending_edges.resize(unique);
+
+    // counting sort of both edge directions into rows
+    row_offsets.assign(section_count + 1, 0);
+    for (const PendingEdge& edge : pending_edges) {
+        row_offsets[edge.from + 1]++;
+        row_offsets[edge.to + 1]++;
+    }
+    for (std::size_t i = 0; i < section_count; i++) {
+        row_offsets[i + 1] += row_offsets[i];
+    }
+
+    column_indices.assign(row_offsets[section_count], 0);
+    weights.assign(row_offsets[section_count], 0.0f);
+    std::vector<std::uint32_t> cursor(row_offsets.begin(), row_offsets.end() - 1);
+    for (const PendingEdge& edge : pending_edges) {
+        column_indices[cursor[edge.from]] = edge.to;
+        weights[cursor[edge.from]++] = edge.weight;
+        column_indices[cursor[edge.to]] = edge.from;
+        weights[cursor[edge.to]++] = edge.weight;
+    }
+
+    weight_sums.assign(section_count, 0.0f);
+    max_weight_sum = 0.0f;
+    for (std::size_t row = 0; row < section_count; row++) {
+        float sum = 0.0f;
+        for (std::uint32_t e = row_offsets[row]; e < row_offsets[row + 1]; e++) {
+            sum += weights[e];
+        }
+        weight_sums[row] = sum;
+        max_weight_sum = std::max(max_weight_sum, sum);
+    }
+
+    neighbour_sum.assign(section_count, 0.0f);
+}
+
+CrowdContagionGraph CrowdContagionGraph::stadiumBowl(std::size_t sections, std::size_t tiers,
+                                                     float weight) {
+    CrowdContagionGraph graph(sections);
+    if (sections == 0) {
+        return graph;
+    }
+    tiers = std::max<std::size_t>(1, std::min(tiers, sections));
+    const std::size_t per_ring = (sections + tiers - 1) / tiers;
+
+    for (std::size_t i = 0; i < sections; i++) {
+        const std::size_t ring = i / per_ring;
+        const std::size_t ring_start = ring * per_ring;
+        const std::size_t ring_size = std::min(per_ring, sections - ring_start);
+        const std::size_t seat = i - ring_start;
+
+        // neighbour along the ring, wrapping around the bowl
+        if (ring_size > 1) {
+            const std::size_t next = ring_start + (seat + 1) % ring_size;
+            if (ring_size > 2 || next > i) {
+                graph.addAdjacency(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(next), weight);
+            }
+        }
+        // section directly above in the next tier
+        const std::size_t above = i + per_ring;
+        if (above < sections) {
+            graph.addAdjacency(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(above), weight);
+        }
+    }
+    graph.build();
+    return graph;
+}
+
+void CrowdContagionGraph::diffuse(float* enthusiasm, float rate, float delta_time) {
+    if (section_count == 0 || max_weight_sum <= 0.0f) {
+        return;
+    }
+
+    // with k * weight_sum <= 1 every section's new value is a convex mix of
+    // itself and its neighbours, so diffusion never overshoots
+    float k = rate * delta_time;
+    k = std::min(k, 1.0f / max_weight_sum);
+    if (k <= 0.0f) {
+        return;
+    }
+
+    const std::uint32_t* offsets = row_offsets.data();
+    const std::uint32_t* columns = column_indices.data();
+    const float* w = weights.data();
+    float* sum = neighbour_sum.data();
+
+    // SpMV: neighbour_sum = A * enthusiasm
+    for (std::size_t row = 0; row < section_count; row++) {
+        float acc = 0.0f;
+        for (std::uint32_t e = offsets[row]; e < offsets[row + 1]; e++) {
+            acc += w[e] * enthusiasm[columns[e]];
+        }
+        sum[row] = acc;
+    }
+
+    // dense update, e += k * (A*e - D*e); contiguous so it vectorizes
+    const float* degree = weight_sums.data();
+    for (std::size_t i = 0; i < section_count; i++) {
+        enthusiasm[i] += k * (sum[i] - degree[i] * enthusiasm[i]);
+    }
+}
+
+std::size_t CrowdContagionGraph::getSectionCount() const {
+    return section_count;
+}
+
+std::size_t CrowdContagionGraph::getEdgeCount() const {
+    return column_indices.size() / 2;
+}
+
+const CrowdVector<std::uint32_t>& CrowdContagionGraph::getRowOffsets() const {
+    return row_offsets;
+}
+
+const CrowdVector<std::uint32_t>& CrowdContagionGraph::getColumnIndices() const {
+    return column_indices;
+}
+
+const CrowdVector<float>& CrowdContagionGraph::getWeights() const {
+    return weights;
+}
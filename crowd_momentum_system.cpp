@@ -0,0 +1,365 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr float kEffectDuration = 10.0f;
+
+float effectMagnitude(MomentumLevel level) {
+    // modest on purpose: momentum should flavour plays, not decide them
+    return level == MomentumLevel::VERY_HIGH ? 0.06f
+         : level == MomentumLevel::HIGH ? 0.03f
+         : 0.0f;
+}
+
+} // namespace
+
+CrowdMomentumSystem::CrowdMomentumSystem(GameState* gameState, Stadium* stadium)
+    : momentum_meter(std::make_unique<MomentumMeter>()),
+      game_state(gameState),
+      stadium(stadium),
+      system_enabled(true),
+      update_frequency(30.0f),
+      elapsed_time(0.0),
+      time_accumulator(0.0f),
+      recording(nullptr),
+      crowd_pending_time(0.0f),
+      crowd_lod_ticks(0),
+      history_interval(1.0f),
+      history_timer(0.0f) {
+}
+
+CrowdMomentumSystem::~CrowdMomentumSystem() {
+    // the game objects are expected to outlive the system, so players must
+    // stop pointing at it
+    shutdown();
+    while (!registered_players.empty()) {
+        unregisterPlayer(*registered_players.back());
+    }
+}
+
+void CrowdMomentumSystem::initialize() {
+    momentum_meter->resetMomentum();
+    momentum_meter->setEventBus(&event_bus);
+    if (stadium != nullptr && stadium->getCrowd() != nullptr) {
+        stadium->getCrowd()->setEventBus(&event_bus);
+    }
+
+    if (game_state != nullptr) {
+        for (Team* team : {game_state->getHomeTeam(), game_state->getAwayTeam()}) {
+            if (team == nullptr) {
+                continue;
+            }
+            for (Player* player : team->getPlayers()) {
+                if (player->getModifierSlot() == kNoModifierSlot) {
+                    registerPlayer(*player);
+                }
+            }
+        }
+    }
+
+    elapsed_time = 0.0;
+    time_accumulator = 0.0f;
+    crowd_pending_time = 0.0f;
+    crowd_lod_ticks = 0;
+    history_timer = 0.0f;
+    history.clear();
+    system_enabled = true;
+}
+
+void CrowdMomentumSystem::processGameEvent(const GameEvent& event) {
+    if (!system_enabled || event.getTeam() == nullptr) {
+        return;
+    }
+
+    // a loud home crowd and a rivalry both amplify the swing
+    float impact = event.getMomentumImpact();
+    Crowd* crowd = stadium != nullptr ? stadium->getCrowd() : nullptr;
+    if (stadium != nullptr) {
+        if (event.isHomeTeamEvent()) {
+            const float volume = crowd != nullptr ? crowd->getVolumeLevel() : 0.0f;
+            impact *= 1.0f + stadium->getHomeFieldAdvantage() * volume;
+        }
+        if (game_state != nullptr && game_state->isRivalryGame()) {
+            impact *= stadium->getRivalryMultiplier();
+        }
+    }
+
+    momentum_meter->adjustMomentum(*event.getTeam(), impact);
+    if (recording != nullptr) {
+        recording->recordEvent(elapsed_time + time_accumulator, impact, event.isHomeTeamEvent());
+    }
+    if (crowd != nullptr) {
+        crowd->reactToEvent(event);
+    }
+}
+
+void CrowdMomentumSystem::updateMomentum(float delta_time) {
+    if (!system_enabled || !(delta_time > 0.0f)) {
+        return;
+    }
+
+    // fixed steps keep live play and what-if replays in lockstep
+    const float step = 1.0f / update_frequency;
+    time_accumulator += delta_time;
+    std::size_t ticks_due = static_cast<std::size_t>(time_accumulator / step);
+    while (time_accumulator >= step) {
+        time_accumulator -= step;
+        tick(step, scheduler.planTick(ticks_due > 0 ? ticks_due-- : 1));
+    }
+    // a deadline covers the update it was set for; later updates run in
+    // full until the caller sets the next one
+    scheduler.dropExpiredDeadline();
+
+    event_bus.dispatch();
+    momentum_meter->clearLevelChanges();
+}
+
+void CrowdMomentumSystem::tick(float step, TickDegradation degradation) {
+    // stage costs are only measured while a deadline makes them matter
+    const bool timed = scheduler.hasDeadline();
+    auto mark = timed ? TickScheduler::Clock::now() : TickScheduler::Clock::time_point();
+    float critical = 0.0f;
+    auto lap = [&]() {
+        if (!timed) {
+            return 0.0f;
+        }
+        const auto now = TickScheduler::Clock::now();
+        const float seconds = std::chrono::duration<float>(now - mark).count();
+        mark = now;
+        return seconds;
+    };
+
+    // critical work first, so it finishes even when the optional stages
+    // below overrun; effects see the crowd volume of the previous tick
+    elapsed_time += step;
+    momentum_meter->decayMomentum(step);
+
+    for (auto& effect : active_effects) {
+        effect->update(step);
+    }
+
+    if (game_state != nullptr) {
+        for (Team* team : {game_state->getHomeTeam(), game_state->getAwayTeam()}) {
+            if (team != nullptr && team->getCoach() != nullptr) {
+                team->getCoach()->updateCooldown(step);
+            }
+        }
+    }
+
+    applyMomentumEffects();
+    critical += lap();
+    if (timed) {
+        scheduler.recordCost(TickStage::CRITICAL, critical);
+    }
+
+    if (stadium != nullptr && stadium->getCrowd() != nullptr) {
+        Crowd* crowd = stadium->getCrowd();
+        // at crowd LOD the contagion runs every few ticks over the summed
+        // step; with no budget left it waits, and the step keeps adding up
+        crowd_pending_time += step;
+        crowd_lod_ticks++;
+        if (degradation == TickDegradation::FULL ||
+            (degradation < TickDegradation::CRITICAL_ONLY && crowd_lod_ticks >= kCrowdLodStride)) {
+            crowd->spreadEnthusiasm(crowd_pending_time);
+            crowd_pending_time = 0.0f;
+            crowd_lod_ticks = 0;
+            scheduler.recordCost(TickStage::CROWD, lap());
+        }
+        if (degradation < TickDegradation::NO_NOISE) {
+            crowd->generateNoise();
+            scheduler.recordCost(TickStage::NOISE, lap());
+        }
+    }
+    lap();
+
+    history_timer += step;
+    if (history_interval > 0.0f && history_timer >= history_interval &&
+        degradation < TickDegradation::NO_HISTORY && game_state != nullptr &&
+        game_state->getHomeTeam() != nullptr && game_state->getAwayTeam() != nullptr) {
+        history.push_back({static_cast<float>(elapsed_time), momentum_meter->getMomentum(*game_state->getHomeTeam()),
+                           momentum_meter->getMomentum(*game_state->getAwayTeam())});
+        // after a stretch without samples, restart the interval instead of catching up
+        history_timer = history_timer >= 2.0f * history_interval ? 0.0f : history_timer - history_interval;
+        scheduler.recordCost(TickStage::HISTORY, lap());
+    }
+}
+
+void CrowdMomentumSystem::applyMomentumEffects() {
+    if (!system_enabled || game_state == nullptr) {
+        return;
+    }
+    Team* home = game_state->getHomeTeam();
+    Team* away = game_state->getAwayTeam();
+
+    // whichever side is riding momentum plays a little sharper
+    for (Team* team : {home, away}) {
+        if (team == nullptr) {
+            continue;
+        }
+        const float magnitude = effectMagnitude(momentum_meter->getMomentumLevel(*team));
+        if (magnitude > 0.0f) {
+            applyTeamEffect(team, EffectType::REACTION_TIME_BOOST, magnitude);
+            applyTeamEffect(team, EffectType::ACCURACY_BOOST, magnitude);
+            applyTeamEffect(team, EffectType::BLOCKING_EFFICIENCY, magnitude);
+        }
+    }
+
+    // a rocking home crowd rattles the visitors
+    Crowd* crowd = stadium != nullptr ? stadium->getCrowd() : nullptr;
+    if (home != nullptr && away != nullptr && crowd != nullptr && !crowd->isQuiet()) {
+        const float magnitude = effectMagnitude(momentum_meter->getMomentumLevel(*home)) * crowd->getVolumeLevel();
+        if (magnitude > 0.0f) {
+            applyTeamEffect(away, EffectType::SNAP_TIMING_PENALTY, magnitude);
+            applyTeamEffect(away, EffectType::FOCUS_REDUCTION, magnitude);
+            applyTeamEffect(away, EffectType::FALSE_START_INCREASE, magnitude);
+        }
+    }
+
+    // players drop expired effects and pick up refreshed magnitudes, then
+    // the batched modifier table is rebuilt for this tick's queries
+    modifier_table.clearModifiers();
+    for (Player* player : registered_players) {
+        player->updateEffects(0.0f);
+        player->accumulateModifiers(modifier_table);
+    }
+    expireEffects();
+}
+
+void CrowdMomentumSystem::applyTeamEffect(Team* team, EffectType type, float magnitude) {
+    for (auto& effect : active_effects) {
+        if (effect->getTargetTeam() == team && effect->getEffectType() == type && effect->isActive()) {
+            effect->refresh(magnitude);
+            return;
+        }
+    }
+
+    active_effects.push_back(std::make_unique<MomentumEffect>(type, magnitude, kEffectDuration, team));
+    MomentumEffect* effect = active_effects.back().get();
+    for (Player* player : team->getPlayers()) {
+        effect->apply(*player);
+    }
+}
+
+void CrowdMomentumSystem::expireEffects() {
+    auto expired = std::stable_partition(active_effects.begin(), active_effects.end(),
+                                         [](const std::unique_ptr<MomentumEffect>& e) { return e->isActive(); });
+    for (auto it = expired; it != active_effects.end(); ++it) {
+        for (Player* player : (*it)->getTargetTeam()->getPlayers()) {
+            (*it)->remove(*player);
+        }
+    }
+    active_effects.erase(expired, active_effects.end());
+}
+
+void CrowdMomentumSystem::shutdown() {
+    for (auto& effect : active_effects) {
+        for (Player* player : effect->getTargetTeam()->getPlayers()) {
+            effect->remove(*player);
+        }
+    }
+    active_effects.clear();
+    modifier_table.clearModifiers();
+    event_bus.clearPending();
+
+    momentum_meter->setEventBus(nullptr);
+    if (stadium != nullptr && stadium->getCrowd() != nullptr) {
+        stadium->getCrowd()->setEventBus(nullptr);
+    }
+    system_enabled = false;
+}
+
+void CrowdMomentumSystem::enableSystem() {
+    system_enabled = true;
+}
+
+void CrowdMomentumSystem::disableSystem() {
+    system_enabled = false;
+}
+
+void CrowdMomentumSystem::setUpdateFrequency(float frequency) {
+    if (frequency > 0.0f) {
+        update_frequency = frequency;
+    }
+}
+
+float CrowdMomentumSystem::getUpdateFrequency() const {
+    return update_frequency;
+}
+
+MomentumMeter* CrowdMomentumSystem::getMomentumMeter() const {
+    return momentum_meter.get();
+}
+
+void CrowdMomentumSystem::attachRecording(GameRecording* newRecording) {
+    recording = newRecording;
+}
+
+void CrowdMomentumSystem::detachRecording() {
+    recording = nullptr;
+}
+
+double CrowdMomentumSystem::getElapsedTime() const {
+    return elapsed_time;
+}
+
+void CrowdMomentumSystem::registerPlayer(Player& player) {
+    player.setModifierSlot(modifier_table.allocateSlot());
+    player.setMomentumSystem(this);
+    registered_players.push_back(&player);
+}
+
+void CrowdMomentumSystem::unregisterPlayer(Player& player) {
+    auto it = std::find(registered_players.begin(), registered_players.end(), &player);
+    if (it == registered_players.end()) {
+        return;
+    }
+    registered_players.erase(it);
+    modifier_table.releaseSlot(player.getModifierSlot());
+    player.setModifierSlot(kNoModifierSlot);
+    player.setMomentumSystem(nullptr);
+}
+
+void CrowdMomentumSystem::queryModifiers(const std::vector<ModifierQuery>& queries,
+                                         std::vector<float>& modifiers) const {
+    modifier_table.gather(queries, modifiers);
+}
+
+ModifierQuery CrowdMomentumSystem::makeModifierQuery(const Player& player, EffectType effect) const {
+    return MomentumModifierTable::makeQuery(player.getModifierSlot(), effect);
+}
+
+const MomentumModifierTable& CrowdMomentumSystem::getModifierTable() const {
+    return modifier_table;
+}
+
+MomentumEventBus& CrowdMomentumSystem::getEventBus() {
+    return event_bus;
+}
+
+void CrowdMomentumSystem::setTickDeadline(TickScheduler::Clock::time_point deadline) {
+    scheduler.setDeadline(deadline);
+}
+
+void CrowdMomentumSystem::clearTickDeadline() {
+    scheduler.clearDeadline();
+}
+
+const TickScheduler& CrowdMomentumSystem::getScheduler() const {
+    return scheduler;
+}
+
+void CrowdMomentumSystem::setHistoryInterval(float interval) {
+    history_interval = interval > 0.0f ? interval : 0.0f;
+    history_timer = 0.0f;
+}
+
+const std::vector<MomentumSample>& CrowdMomentumSystem::getHistory() const {
+    return history;
+}
+
+void CrowdMomentumSystem::clearHistory() {
+    history.clear();
+}
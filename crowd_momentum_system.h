@@ -1,76 +1,32 @@
 #ifndef CROWD_MOMENTUM_SYSTEM_H
 #define CROWD_MOMENTUM_SYSTEM_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
 
+#include "crowd_contagion.h"
+#include "memory_accounting.h"
+#include "momentum_events.h"
+#include "momentum_levels.h"
+#include "momentum_modifiers.h"
+#include "momentum_scheduler.h"
+#include "momentum_sensitivity.h"
+#include "momentum_types.h"
+#include "momentum_what_if.h"
+
 // forward declarations to avoid any circular dependencies
 class Team;
 class Player;
 class Coach;
 class Stadium;
 class Crowd;
-
-// enume...
-enum class EventType {
-    TOUCHDOWN,
-    INTERCEPTION,
-    SACK,
-    FOURTH_DOWN_STOP,
-    FUMBLE,
-    FIELD_GOAL,
-    PENALTY,
-    SAFETY,
-    TURNOVER
-};
-
-enum class EffectType {
-    REACTION_TIME_BOOST,
-    ACCURACY_BOOST,
-    BLOCKING_EFFICIENCY,
-    SNAP_TIMING_PENALTY,
-    FOCUS_REDUCTION,
-    FALSE_START_INCREASE
-};
-
-enum class MomentumLevel {
-    VERY_LOW,
-    LOW,
-    NEUTRAL,
-    HIGH,
-    VERY_HIGH
-};
-
-enum class VenueType {
-    SMALL_STADIUM,
-    MEDIUM_STADIUM,
-    LARGE_STADIUM,
-    DOME_STADIUM,
-    OUTDOOR_STADIUM
-};
-
-enum class Position {
-    QUARTERBACK,
-    RUNNING_BACK,
-    WIDE_RECEIVER,
-    TIGHT_END,
-    OFFENSIVE_LINE,
-    DEFENSIVE_LINE,
-    LINEBACKER,
-    CORNERBACK,
-    SAFETY,
-    KICKER
-};
-
-// utility structures
-struct PlayerStats {
-    float speed;
-    float accuracy;
-    float strength;
-    float awareness;
-    float composure;
-};
+class CrowdSection;
+class MomentumMeter;
+class MomentumEffect;
+class GameEvent;
+class GameState;
 
 /**
  * main controller class for the Dynamic Crowd Momentum System
@@ -83,6 +39,25 @@ private:
     Stadium* stadium;
     bool system_enabled;
     float update_frequency;
+    double elapsed_time;        // a sum of float steps, exact in double
+    float time_accumulator;
+    GameRecording* recording;
+    MomentumModifierTable modifier_table;
+    MomentumEventBus event_bus;
+    TaggedVector<Player*, MemoryTag::ROSTERS> registered_players;
+    TaggedVector<std::unique_ptr<MomentumEffect>, MemoryTag::EFFECTS> active_effects;
+
+    // deadline scheduling and the optional work it may shed
+    TickScheduler scheduler;
+    float crowd_pending_time;
+    int crowd_lod_ticks;
+    float history_interval;
+    float history_timer;
+    std::vector<MomentumSample> history;
+
+    void tick(float step, TickDegradation degradation);
+    void applyTeamEffect(Team* team, EffectType type, float magnitude);
+    void expireEffects();
 
 public:
     // constructor and Destructor
@@ -104,6 +79,39 @@ public:
     // configuration
     void setUpdateFrequency(float frequency);
     float getUpdateFrequency() const;
+    MomentumMeter* getMomentumMeter() const;
+
+    // what-if replays: while a recording is attached every processed
+    // event is appended to it with its computed impact
+    void attachRecording(GameRecording* recording);
+    void detachRecording();
+    double getElapsedTime() const;
+
+    // batched modifier queries: one gather answers every (player, effect)
+    // pair of an upcoming play from the table refreshed each tick. a
+    // registered player unregisters itself when it is destroyed, e.g. by
+    // Team::removePlayer
+    void registerPlayer(Player& player);
+    void unregisterPlayer(Player& player);
+    void queryModifiers(const std::vector<ModifierQuery>& queries, std::vector<float>& modifiers) const;
+    ModifierQuery makeModifierQuery(const Player& player, EffectType effect) const;
+    const MomentumModifierTable& getModifierTable() const;
+
+    // notifications from the meter and crowd, dispatched once per update
+    MomentumEventBus& getEventBus();
+
+    // tick deadline: while set, each update sheds optional work (crowd LOD,
+    // then noise, then history, then contagion) so momentum and effects
+    // finish in time. it lasts until an update ends past it, so set one per
+    // frame
+    void setTickDeadline(TickScheduler::Clock::time_point deadline);
+    void clearTickDeadline();
+    const TickScheduler& getScheduler() const;
+
+    // momentum history, sampled every interval of game time (0 disables)
+    void setHistoryInterval(float interval);
+    const std::vector<MomentumSample>& getHistory() const;
+    void clearHistory();
 };
 
 /**
@@ -118,6 +126,24 @@ private:
     float max_momentum;
     float min_momentum;
 
+    // cached levels, reclassified only when momentum leaves its band
+    MomentumLevelClassifier level_classifier;
+    MomentumLevel home_level;
+    MomentumLevel away_level;
+    float home_band_low;
+    float home_band_high;
+    float away_band_low;
+    float away_band_high;
+    std::vector<MomentumLevelChange> level_changes;
+
+    // threshold state and subscribers
+    bool home_above_threshold;
+    bool away_above_threshold;
+    MomentumEventBus* event_bus;
+
+    // reclassifies and checks the threshold after a team's momentum moved
+    void refreshLevel(bool isHome, float momentum);
+
 public:
     // constructor
     MomentumMeter(float threshold = 50.0f, float decayRate = 0.1f);
@@ -133,26 +159,56 @@ public:
     MomentumLevel getMomentumLevel(const Team& team) const;
     float getMomentumDifference() const;
     bool isAtThreshold(const Team& team) const;
+    const MomentumLevelClassifier& getLevelClassifier() const;
+
+    // band crossings since the last clear, in the order they happened
+    const std::vector<MomentumLevelChange>& getLevelChanges() const;
+    void clearLevelChanges();
 
     // configuration
     void setThreshold(float threshold);
     void setDecayRate(float rate);
     float getThreshold() const;
     float getDecayRate() const;
+    void setMomentumRange(float minMomentum, float maxMomentum);
+
+    // level changes and threshold crossings are queued on this bus
+    void setEventBus(MomentumEventBus* bus);
+    MomentumEventBus* getEventBus() const;
 };
 
 /**
  * crowd's behavior and reactions during gameplay
  */
-class Crowd {
+class Crowd : public MemoryTagged<MemoryTag::CROWD> {
 private:
     float noise_level;
     float enthusiasm;
     Stadium* stadium;
-    std::vector<std::unique_ptr<CrowdSection>> crowd_sections;
+    TaggedVector<std::unique_ptr<CrowdSection>, MemoryTag::CROWD> crowd_sections;
     float base_noise_level;
     float max_noise_level;
 
+    // per-section enthusiasm and attendance in flat arrays, which the tick
+    // path (contagion, noise) works on directly. the CrowdSection objects
+    // are only brought up to date when a play is reacted to
+    TaggedVector<float, MemoryTag::CROWD> section_enthusiasm;
+    TaggedVector<int, MemoryTag::CROWD> section_attendance;
+    long long seat_count;
+    bool sections_stale;
+
+    // enthusiasm contagion between neighbouring sections
+    CrowdContagionGraph contagion_graph;
+    float contagion_rate;
+
+    // noise peak notifications fire when noise rises past the peak level
+    MomentumEventBus* event_bus;
+    float noise_peak_level;
+    bool noise_peaking;
+
+    void pushToSections();
+    void pullFromSections();
+
 public:
     // constructor and Destructor
     Crowd(Stadium* stadium, int num_sections = 8);
@@ -163,6 +219,7 @@ public:
     void generateNoise();
     void updateEnthusiasm(float adjustment);
     void resetCrowd();
+    void spreadEnthusiasm(float delta_time);
 
     // crowd state queries
     float getNoiseLevel() const;
@@ -170,19 +227,26 @@ public:
     float getVolumeLevel() const;
     bool isQuiet() const;
     bool isLoud() const;
+    std::size_t getSectionCount() const;
 
     // configuration
     void setBaseNoiseLevel(float level);
     void setMaxNoiseLevel(float level);
     void addCrowdSection(Team* team, int capacity);
+    void setContagionRate(float rate);
+    float getContagionRate() const;
+    void rebuildContagionGraph(int tiers = 1);
+    void setEventBus(MomentumEventBus* bus);
+    MomentumEventBus* getEventBus() const;
+    void setNoisePeakLevel(float level);
 };
 
 /**
  * Individual section of the crowd with specific team affiliation
  */
-class CrowdSection {
+class CrowdSection : public MemoryTagged<MemoryTag::CROWD> {
 private:
-    std::string section_id;
+    TaggedName section_id;
     Team* team_affiliation;
     int capacity;
     int current_attendance;
@@ -237,12 +301,13 @@ public:
     // impact calculation
     void calculateMomentumImpact(const GameState& gameState);
     void setMomentumImpact(float impact);
+    void setTimestamp(float timestamp);
 };
 
 /**
  * effects applied to players based on current momentum levels
  */
-class MomentumEffect {
+class MomentumEffect : public MemoryTagged<MemoryTag::EFFECTS> {
 private:
     EffectType effect_type;
     float magnitude;
@@ -259,6 +324,7 @@ public:
     void apply(Player& player);
     void remove(Player& player);
     void update(float delta_time);
+    void refresh(float magnitude);
 
     // effect queries
     bool isActive() const;
@@ -272,21 +338,35 @@ public:
 /**
  * individual player affected by momentum system
  */
-class Player {
+class Player : public MemoryTagged<MemoryTag::ROSTERS> {
 private:
-    std::string player_id;
-    std::string player_name;
+    TaggedName player_id;
+    TaggedName player_name;
     Team* team;
     Position position;
     PlayerStats base_stats;
     PlayerStats current_stats;
-    std::vector<MomentumEffect*> current_effects;
+    TaggedVector<MomentumEffect*, MemoryTag::EFFECTS> current_effects;
     float composure_level;
     bool momentum_immune;
+    float experience;
+    MomentumSensitivity sensitivity;
+    std::uint32_t modifier_slot;
+    CrowdMomentumSystem* momentum_system;     // registered with, unregistered on destruction
+    float effect_modifiers[kModifierStride];  // from the last recalculateStats
+
+    void refreshSensitivity();
+    void recalculateStats();
+    void computeEffectModifiers(float* modifiers) const;
 
 public:
     // constructor
     Player(const std::string& id, const std::string& name, Team* team, Position pos);
+    ~Player();
+
+    // a registered player is tracked by address, so it is never copied
+    Player(const Player&) = delete;
+    Player& operator=(const Player&) = delete;
 
     // effect management
     void applyEffect(MomentumEffect* effect);
@@ -302,11 +382,23 @@ public:
     Position getPosition() const;
     Team* getTeam() const;
     std::string getName() const;
+    std::string getId() const;
 
     //configuration
     void setComposureLevel(float level);
     void setMomentumImmune(bool immune);
     void setBaseStats(const PlayerStats& stats);
+
+    // sensitivity curve, rebuilt from position, composure and experience
+    void setExperience(float seasons);
+    float getExperience() const;
+    const MomentumSensitivity& getSensitivity() const;
+
+    // row in the system's modifier table, and the system it belongs to
+    void setModifierSlot(std::uint32_t slot);
+    std::uint32_t getModifierSlot() const;
+    void setMomentumSystem(CrowdMomentumSystem* system);
+    void accumulateModifiers(MomentumModifierTable& table) const;
 };
 
 /**
@@ -314,10 +406,10 @@ public:
  */
 class Team {
 private:
-    std::string team_id;
-    std::string team_name;
+    TaggedName team_id;
+    TaggedName team_name;
     bool is_home_team;
-    std::vector<std::unique_ptr<Player>> players;
+    TaggedVector<std::unique_ptr<Player>, MemoryTag::ROSTERS> players;
     std::unique_ptr<Coach> coach;
     bool composure_mode_active;
     float team_morale;
@@ -355,8 +447,8 @@ public:
  */
 class Coach {
 private:
-    std::string coach_id;
-    std::string coach_name;
+    TaggedName coach_id;
+    TaggedName coach_name;
     Team* team;
     int leadership_rating;
     float composure_cooldown;
@@ -390,8 +482,8 @@ public:
  */
 class Stadium {
 private:
-    std::string stadium_id;
-    std::string stadium_name;
+    TaggedName stadium_id;
+    TaggedName stadium_name;
     int capacity;
     std::unique_ptr<Crowd> crowd;
     VenueType venue_type;
@@ -504,4 +596,71 @@ public:
     void setCooldownTime(float cooldown);
 };
 
-#endif
\ No newline at end of file
+// inline accessors, kept in the header because the tick path and
+// gameplay code call them constantly
+
+inline bool CrowdMomentumSystem::isSystemEnabled() const {
+    return system_enabled;
+}
+
+inline float MomentumMeter::getMomentum(const Team& team) const {
+    return team.isHomeTeam() ? home_momentum : away_momentum;
+}
+
+inline MomentumLevel MomentumMeter::getMomentumLevel(const Team& team) const {
+    return team.isHomeTeam() ? home_level : away_level;
+}
+
+inline bool MomentumMeter::isAtThreshold(const Team& team) const {
+    return getMomentum(team) >= momentum_threshold;
+}
+
+inline float MomentumMeter::getMomentumDifference() const {
+    return home_momentum - away_momentum;
+}
+
+inline float Crowd::getNoiseLevel() const {
+    return noise_level;
+}
+
+inline float Crowd::getEnthusiasm() const {
+    return enthusiasm;
+}
+
+inline float CrowdSection::getNoiseContribution() const {
+    return noise_contribution;
+}
+
+inline float CrowdSection::getEnthusiasm() const {
+    return current_enthusiasm;
+}
+
+inline bool MomentumEffect::isActive() const {
+    return remaining_time > 0.0f;
+}
+
+inline float MomentumEffect::getEffectStrength() const {
+    return isActive() ? magnitude : 0.0f;
+}
+
+inline EffectType MomentumEffect::getEffectType() const {
+    return effect_type;
+}
+
+inline bool Player::isAffectedByMomentum() const {
+    return !momentum_immune;
+}
+
+inline std::uint32_t Player::getModifierSlot() const {
+    return modifier_slot;
+}
+
+inline bool Team::isHomeTeam() const {
+    return is_home_team;
+}
+
+inline bool TeamComposureMode::isActive() const {
+    return is_active;
+}
+
+#endif
@@ -0,0 +1,567 @@
+#ifndef EVENT_SOURCED_INVENTORY_H
+#define EVENT_SOURCED_INVENTORY_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "inventory.h"
+#include "memory_accounting.h"
+
+enum class InventoryEventType : uint8_t {
+    ITEM_ADDED,
+    ITEM_SOLD
+};
+
+// one change to the inventory. item_index is the stock line's position when
+// the event happened (for an add, the position it was appended at); money is
+// what a sale added to total_money
+struct InventoryEvent {
+    uint64_t sequence;
+    InventoryEventType type;
+    uint32_t item_index;
+    std::string name;
+    int quantity;
+    float price;
+    float money;
+};
+
+struct StockLine {
+    std::string name;
+    int quantity;
+    float price;
+};
+
+// the inventory as of one sequence number: its stock lines in item order
+// and its total_money
+struct InventoryState {
+    uint64_t sequence = 0;
+    float total_money = 0;
+    std::vector<StockLine> items;
+};
+
+// inventory that records every add and sale in an append-only event log,
+// so its state at any past sequence number can be rebuilt.
+//
+// events go into an open segment of raw events. a full segment is sealed
+// and handed to a background compactor, which encodes it into a byte
+// string (varints, shared name prefixes) at a fraction of the raw size and
+// applies it to a shadow copy of the state. whenever the encoded events
+// since the last snapshot outweigh an encoding of that state, the shadow is
+// stored as a new snapshot, so replaying from the nearest snapshot never
+// decodes more than about one state's worth of events. the first event is
+// sequence 1; sequence 0 is the empty inventory.
+//
+// the public calls are meant for one thread, which owns the live inventory
+// and the open segment; the compactor only touches the sealed segments,
+// snapshots and its shadow state, under history_mutex.
+class EventSourcedInventory {
+private:
+    using Bytes = TaggedVector<uint8_t, MemoryTag::INVENTORY_ITEMS>;
+
+    struct EncodedSegment {
+        uint64_t first_sequence;
+        size_t event_count;
+        Bytes data;
+    };
+
+    struct Snapshot {
+        uint64_t sequence;
+        float total_money;
+        size_t item_count;
+        Bytes data;
+    };
+
+    Inventory inventory;
+    size_t segment_events;
+    uint64_t next_sequence;
+    std::vector<InventoryEvent> open_segment;
+
+    mutable std::mutex history_mutex;
+    std::condition_variable compactor_wake;
+    std::condition_variable compactor_idle;
+    std::deque<std::vector<InventoryEvent>> sealed;     // waiting for the compactor, oldest first
+    std::deque<EncodedSegment> segments;
+    std::deque<Snapshot> snapshots;                     // sequence order, the first one at or before segments
+    uint64_t first_retained;                            // oldest event not yet discarded
+    bool compacting;
+    bool stopping;
+
+    // compactor-only: state after the last encoded segment, the encoded
+    // bytes since the last snapshot and the size of that snapshot
+    InventoryState shadow;
+    size_t bytes_since_snapshot;
+    size_t snapshot_bytes;
+    std::thread compactor;
+
+    static void put_varint(Bytes &out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t get_varint(const uint8_t *&in) {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *in++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+    }
+
+    static void put_float(Bytes &out, float value) {
+        uint8_t bytes[sizeof(float)];
+        std::memcpy(bytes, &value, sizeof(float));
+        out.insert(out.end(), bytes, bytes + sizeof(float));
+    }
+
+    static float get_float(const uint8_t *&in) {
+        float value;
+        std::memcpy(&value, in, sizeof(float));
+        in += sizeof(float);
+        return value;
+    }
+
+    // a name as the length it shares with the previous one plus the rest
+    static void put_name(Bytes &out, const std::string &name, const std::string &previous) {
+        size_t shared = 0;
+        size_t limit = std::min(previous.size(), name.size());
+        while (shared < limit && previous[shared] == name[shared]) {
+            shared++;
+        }
+        put_varint(out, static_cast<uint32_t>(shared));
+        put_varint(out, static_cast<uint32_t>(name.size() - shared));
+        out.insert(out.end(), name.begin() + static_cast<long>(shared), name.end());
+    }
+
+    static void get_name(const uint8_t *&in, std::string *name) {
+        size_t shared = get_varint(in);
+        size_t suffix = get_varint(in);
+        name->resize(shared);
+        name->append(reinterpret_cast<const char *>(in), suffix);
+        in += suffix;
+    }
+
+    static EncodedSegment encode(const std::vector<InventoryEvent> &events) {
+        EncodedSegment segment{events.front().sequence, events.size(), {}};
+        std::string previous;
+        for (const InventoryEvent &event : events) {
+            segment.data.push_back(static_cast<uint8_t>(event.type));
+            put_varint(segment.data, event.item_index);
+            put_name(segment.data, event.name, previous);
+            put_varint(segment.data, static_cast<uint32_t>(event.quantity));
+            put_float(segment.data, event.price);
+            if (event.type == InventoryEventType::ITEM_SOLD) {
+                put_float(segment.data, event.money);
+            }
+            previous = event.name;
+        }
+        segment.data.shrink_to_fit();
+        return segment;
+    }
+
+    // calls visit for each event of the segment up to last_sequence
+    template<typename Visit>
+    static void decode(const EncodedSegment &segment, uint64_t last_sequence, Visit &&visit) {
+        const uint8_t *in = segment.data.data();
+        InventoryEvent event{0, InventoryEventType::ITEM_ADDED, 0, {}, 0, 0, 0};
+        for (size_t i = 0; i < segment.event_count && segment.first_sequence + i <= last_sequence; i++) {
+            event.sequence = segment.first_sequence + i;
+            event.type = static_cast<InventoryEventType>(*in++);
+            event.item_index = get_varint(in);
+            get_name(in, &event.name);
+            event.quantity = static_cast<int>(get_varint(in));
+            event.price = get_float(in);
+            event.money = event.type == InventoryEventType::ITEM_SOLD ? get_float(in) : 0;
+            visit(event);
+        }
+    }
+
+    static Snapshot encode(const InventoryState &state) {
+        Snapshot snapshot{state.sequence, state.total_money, state.items.size(), {}};
+        const std::string empty;
+        const std::string *previous = &empty;
+        for (const StockLine &line : state.items) {
+            put_name(snapshot.data, line.name, *previous);
+            put_varint(snapshot.data, static_cast<uint32_t>(line.quantity));
+            put_float(snapshot.data, line.price);
+            previous = &line.name;
+        }
+        snapshot.data.shrink_to_fit();
+        return snapshot;
+    }
+
+    static void decode(const Snapshot &snapshot, InventoryState *state) {
+        state->sequence = snapshot.sequence;
+        state->total_money = snapshot.total_money;
+        state->items.assign(snapshot.item_count, StockLine{});
+        const uint8_t *in = snapshot.data.data();
+        for (size_t i = 0; i < snapshot.item_count; i++) {
+            StockLine &line = state->items[i];
+            if (i > 0) {
+                line.name = state->items[i - 1].name;
+            }
+            get_name(in, &line.name);
+            line.quantity = static_cast<int>(get_varint(in));
+            line.price = get_float(in);
+        }
+    }
+
+    // applies a run of events to a state with the same effect on the stock
+    // lines as the Inventory calls that logged them, including the float
+    // additions to total_money. a sale names its line by position, and
+    // positions shift at every sell-out, so sold-out lines are only emptied
+    // while replaying: a Fenwick tree counting the live lines maps a position
+    // to its slot, and finish() drops the empty lines in one pass.
+    class Replay {
+    private:
+        InventoryState *state;
+        std::vector<uint32_t> tree;     // 1-based, live lines per range
+
+        void push_slot() {
+            size_t i = tree.size();
+            size_t low = i & (~i + 1);
+            uint32_t count = 1;
+            // ranges (i - low, i - 1] merged into node i
+            for (size_t step = 1; step < low; step <<= 1) {
+                count += tree[i - step];
+            }
+            tree.push_back(count);
+        }
+
+        size_t slot_of(size_t position) const {
+            size_t slot = 0;
+            size_t remaining = position + 1;
+            size_t top = 1;
+            while (top * 2 < tree.size()) {
+                top *= 2;
+            }
+            for (size_t step = top; step > 0; step >>= 1) {
+                if (slot + step < tree.size() && tree[slot + step] < remaining) {
+                    slot += step;
+                    remaining -= tree[slot];
+                }
+            }
+            return slot;
+        }
+
+        void clear_slot(size_t slot) {
+            for (size_t i = slot + 1; i < tree.size(); i += i & (~i + 1)) {
+                tree[i]--;
+            }
+        }
+
+    public:
+        explicit Replay(InventoryState *state) :
+                state{state},
+                tree{0} {
+            tree.reserve(state->items.size() + 1);
+            for (size_t i = 0; i < state->items.size(); i++) {
+                push_slot();
+            }
+        }
+
+        void apply(const InventoryEvent &event) {
+            if (event.type == InventoryEventType::ITEM_ADDED) {
+                state->items.push_back(StockLine{event.name, event.quantity, event.price});
+                push_slot();
+            } else {
+                size_t slot = slot_of(event.item_index);
+                StockLine &line = state->items[slot];
+                line.quantity -= event.quantity;
+                state->total_money += event.money;
+                if (line.quantity == 0) {
+                    clear_slot(slot);
+                }
+            }
+            state->sequence = event.sequence;
+        }
+
+        void finish() {
+            state->items.erase(std::remove_if(state->items.begin(), state->items.end(),
+                                              [](const StockLine &line) { return line.quantity == 0; }),
+                               state->items.end());
+        }
+    };
+
+    void append(InventoryEventType type, uint32_t item_index, const std::string &name, int quantity, float price,
+                float money) {
+        open_segment.push_back(InventoryEvent{next_sequence++, type, item_index, name, quantity, price, money});
+        if (open_segment.size() >= segment_events) {
+            std::lock_guard<std::mutex> lock(history_mutex);
+            sealed.push_back(std::move(open_segment));
+            open_segment.clear();
+            open_segment.reserve(segment_events);
+            compactor_wake.notify_one();
+        }
+    }
+
+    void compact_loop() {
+        std::unique_lock<std::mutex> lock(history_mutex);
+        while (true) {
+            compactor_wake.wait(lock, [&] { return stopping || !sealed.empty(); });
+            if (sealed.empty()) {
+                return;
+            }
+            compacting = true;
+            // the front segment stays visible to readers while it is encoded;
+            // only this thread removes it
+            const std::vector<InventoryEvent> &events = sealed.front();
+            lock.unlock();
+
+            EncodedSegment segment = encode(events);
+            Replay run(&shadow);
+            for (const InventoryEvent &event : events) {
+                run.apply(event);
+            }
+            run.finish();
+            bytes_since_snapshot += segment.data.size();
+            bool take_snapshot = false;
+            Snapshot snapshot{};
+            if (bytes_since_snapshot >= snapshot_bytes) {
+                snapshot = encode(shadow);
+                take_snapshot = true;
+                bytes_since_snapshot = 0;
+                snapshot_bytes = snapshot.data.size();
+            }
+
+            lock.lock();
+            segments.push_back(std::move(segment));
+            if (take_snapshot) {
+                snapshots.push_back(std::move(snapshot));
+            }
+            sealed.pop_front();
+            compacting = false;
+            compactor_idle.notify_all();
+        }
+    }
+
+    // replays every compacted or sealed event after state->sequence up to
+    // last_sequence; the caller holds history_mutex
+    void replay(uint64_t last_sequence, InventoryState *state, Replay *run) const {
+        auto visit = [&](const InventoryEvent &event) {
+            if (event.sequence > state->sequence) {
+                run->apply(event);
+            }
+        };
+        // segments are in sequence order: skip to the one holding the next event
+        auto first = std::upper_bound(segments.begin(), segments.end(), state->sequence,
+                                      [](uint64_t sequence, const EncodedSegment &segment) {
+                                          return sequence < segment.first_sequence;
+                                      });
+        if (first != segments.begin()) {
+            --first;
+        }
+        for (auto segment = first; segment != segments.end(); ++segment) {
+            if (segment->first_sequence > last_sequence) {
+                return;
+            }
+            decode(*segment, last_sequence, visit);
+        }
+        for (const auto &events : sealed) {
+            for (const InventoryEvent &event : events) {
+                if (event.sequence > last_sequence) {
+                    return;
+                }
+                visit(event);
+            }
+        }
+    }
+
+public:
+    explicit EventSourcedInventory(size_t segment_events = 4096) :
+            inventory{},
+            segment_events{std::max<size_t>(1, segment_events)},
+            next_sequence{1},
+            open_segment{},
+            history_mutex{},
+            compactor_wake{},
+            compactor_idle{},
+            sealed{},
+            segments{},
+            snapshots{},
+            first_retained{1},
+            compacting{false},
+            stopping{false},
+            shadow{},
+            bytes_since_snapshot{0},
+            snapshot_bytes{0},
+            compactor{} {
+        open_segment.reserve(this->segment_events);
+        snapshots.push_back(encode(shadow));
+        compactor = std::thread(&EventSourcedInventory::compact_loop, this);
+    }
+
+    EventSourcedInventory(const EventSourcedInventory &) = delete;
+    EventSourcedInventory &operator=(const EventSourcedInventory &) = delete;
+
+    ~EventSourcedInventory() {
+        {
+            std::lock_guard<std::mutex> lock(history_mutex);
+            stopping = true;
+        }
+        compactor_wake.notify_one();
+        compactor.join();
+    }
+
+    bool add_item(std::string name, int quantity, float price) {
+        uint32_t item_index = static_cast<uint32_t>(inventory.item_count());
+        if (!inventory.add_item(name, quantity, price)) {
+            return false;
+        }
+        append(InventoryEventType::ITEM_ADDED, item_index, name, quantity, price, 0);
+        return true;
+    }
+
+    SaleStatus sell(const std::string &name, int quantity, float *money_earned = nullptr) {
+        size_t item_index = inventory.find_item(name);
+        if (item_index == Inventory::npos) {
+            return SaleStatus::NOT_FOUND;
+        }
+        float price = inventory.get_items()[item_index].get_price();
+        float earned = 0;
+        SaleStatus status = inventory.sell_at(item_index, quantity, &earned);
+        if (status == SaleStatus::SOLD || status == SaleStatus::SOLD_OUT) {
+            append(InventoryEventType::ITEM_SOLD, static_cast<uint32_t>(item_index), name, quantity, price, earned);
+            if (money_earned != nullptr) {
+                *money_earned = earned;
+            }
+        }
+        return status;
+    }
+
+    // the live inventory, at last_sequence()
+    const Inventory &get_inventory() const {
+        return inventory;
+    }
+
+    // sequence number of the latest event, 0 before the first
+    uint64_t last_sequence() const {
+        return next_sequence - 1;
+    }
+
+    // rebuilds the state as of sequence from the nearest snapshot at or
+    // before it plus the events after that; false if sequence is in the
+    // future or older than the retained history
+    bool state_at(uint64_t sequence, InventoryState *state) const {
+        if (sequence > last_sequence()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(history_mutex);
+        auto nearest = std::upper_bound(snapshots.begin(), snapshots.end(), sequence,
+                                        [](uint64_t s, const Snapshot &snapshot) {
+                                            return s < snapshot.sequence;
+                                        });
+        if (nearest == snapshots.begin()) {
+            return false;
+        }
+        decode(*(nearest - 1), state);
+        Replay run(state);
+        replay(sequence, state, &run);
+        for (const InventoryEvent &event : open_segment) {
+            if (event.sequence > sequence) {
+                break;
+            }
+            if (event.sequence > state->sequence) {
+                run.apply(event);
+            }
+        }
+        run.finish();
+        return true;
+    }
+
+    // the logged events first..last, for audit; false, with events left
+    // empty, if last is in the future or first is older than the retained
+    // history. sequence 0 has no event, so first 0 reads as 1
+    bool get_events(uint64_t first, uint64_t last, std::vector<InventoryEvent> *events) const {
+        events->clear();
+        first = std::max<uint64_t>(first, 1);
+        if (last > last_sequence()) {
+            return false;
+        }
+        auto visit = [&](const InventoryEvent &event) {
+            if (event.sequence >= first && event.sequence <= last) {
+                events->push_back(event);
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(history_mutex);
+            if (first < first_retained) {
+                return false;
+            }
+            for (const EncodedSegment &segment : segments) {
+                if (segment.first_sequence + segment.event_count > first && segment.first_sequence <= last) {
+                    decode(segment, last, visit);
+                }
+            }
+            for (const auto &pending : sealed) {
+                for (const InventoryEvent &event : pending) {
+                    visit(event);
+                }
+            }
+        }
+        for (const InventoryEvent &event : open_segment) {
+            visit(event);
+        }
+        return true;
+    }
+
+    // drops the snapshots and encoded events that no state at or after
+    // sequence needs; history before the remaining first snapshot is gone,
+    // and state_at and get_events report it so
+    void discard_before(uint64_t sequence) {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        while (snapshots.size() > 1 && snapshots[1].sequence <= sequence) {
+            snapshots.pop_front();
+        }
+        while (!segments.empty() && segments.front().first_sequence + segments.front().event_count - 1 <=
+                                            snapshots.front().sequence) {
+            first_retained = segments.front().first_sequence + segments.front().event_count;
+            segments.pop_front();
+        }
+    }
+
+    // sequence of the oldest event get_events can still return
+    uint64_t first_retained_sequence() const {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        return first_retained;
+    }
+
+    // waits until the compactor has encoded every sealed segment
+    void wait_for_compaction() {
+        std::unique_lock<std::mutex> lock(history_mutex);
+        compactor_idle.wait(lock, [&] { return sealed.empty() && !compacting; });
+    }
+
+    size_t snapshot_count() const {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        return snapshots.size();
+    }
+
+    // bytes of encoded history: compacted segments plus snapshots
+    size_t history_bytes() const {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        size_t bytes = 0;
+        for (const EncodedSegment &segment : segments) {
+            bytes += segment.data.size();
+        }
+        for (const Snapshot &snapshot : snapshots) {
+            bytes += snapshot.data.size();
+        }
+        return bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "crowd_momentum_system.h"
+
+namespace {
+
+// momentum swing of each event before game context is applied
+float baseImpact(EventType type) {
+    switch (type) {
+        case EventType::TOUCHDOWN:        return 12.0f;
+        case EventType::INTERCEPTION:     return 10.0f;
+        case EventType::FUMBLE:           return 9.0f;
+        case EventType::TURNOVER:         return 9.0f;
+        case EventType::FOURTH_DOWN_STOP: return 8.0f;
+        case EventType::SAFETY:           return 7.0f;
+        case EventType::SACK:             return 6.0f;
+        case EventType::FIELD_GOAL:       return 4.0f;
+        case EventType::PENALTY:          return -3.0f;
+    }
+    return 0.0f;
+}
+
+} // namespace
+
+GameEvent::GameEvent(EventType type, Team* team, Player* player)
+    : event_type(type),
+      team(team),
+      player(player),
+      momentum_impact(baseImpact(type)),
+      timestamp(0.0f),
+      is_home_team_event(team != nullptr && team->isHomeTeam()) {
+}
+
+EventType GameEvent::getEventType() const {
+    return event_type;
+}
+
+Team* GameEvent::getTeam() const {
+    return team;
+}
+
+Player* GameEvent::getPlayer() const {
+    return player;
+}
+
+float GameEvent::getMomentumImpact() const {
+    return momentum_impact;
+}
+
+float GameEvent::getTimestamp() const {
+    return timestamp;
+}
+
+bool GameEvent::isHomeTeamEvent() const {
+    return is_home_team_event;
+}
+
+void GameEvent::calculateMomentumImpact(const GameState& gameState) {
+    // tense moments (late, close, rivalry, playoff) swing momentum harder
+    float impact = baseImpact(event_type) * (1.0f + 0.5f * gameState.getGameTension());
+    if (gameState.isLateGame() && gameState.isCloseGame()) {
+        impact *= 1.25f;
+    }
+    momentum_impact = impact;
+}
+
+void GameEvent::setMomentumImpact(float impact) {
+    momentum_impact = impact;
+}
+
+void GameEvent::setTimestamp(float newTimestamp) {
+    timestamp = newTimestamp;
+}
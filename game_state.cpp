@@ -0,0 +1,124 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+constexpr int kQuarterLength = 15 * 60;
+
+} // namespace
+
+GameState::GameState(Team* homeTeam, Team* awayTeam)
+    : current_quarter(1),
+      time_remaining(kQuarterLength),
+      home_score(0),
+      away_score(0),
+      home_team(homeTeam),
+      away_team(awayTeam),
+      is_rivalry_game(false),
+      is_playoff_game(false),
+      game_tension(0.0f) {
+    calculateGameTension();
+}
+
+int GameState::getCurrentQuarter() const {
+    return current_quarter;
+}
+
+int GameState::getTimeRemaining() const {
+    return time_remaining;
+}
+
+void GameState::setTime(int quarter, int time) {
+    current_quarter = std::max(1, quarter);
+    time_remaining = std::max(0, time);
+    calculateGameTension();
+}
+
+void GameState::updateTime(int seconds) {
+    time_remaining -= seconds;
+    // roll into the next quarter; the clock stops at the end of the fourth
+    while (time_remaining <= 0 && current_quarter < 4) {
+        current_quarter++;
+        time_remaining += kQuarterLength;
+    }
+    time_remaining = std::max(0, time_remaining);
+    calculateGameTension();
+}
+
+int GameState::getHomeScore() const {
+    return home_score;
+}
+
+int GameState::getAwayScore() const {
+    return away_score;
+}
+
+int GameState::getScoreDifference() const {
+    return home_score - away_score;
+}
+
+void GameState::updateScore(Team* team, int points) {
+    if (team == home_team) {
+        home_score += points;
+    } else if (team == away_team) {
+        away_score += points;
+    }
+    calculateGameTension();
+}
+
+bool GameState::isLateGame() const {
+    return current_quarter >= 4 && time_remaining <= 5 * 60;
+}
+
+bool GameState::isCloseGame() const {
+    return std::abs(getScoreDifference()) <= 8;
+}
+
+bool GameState::isRivalryGame() const {
+    return is_rivalry_game;
+}
+
+bool GameState::isPlayoffGame() const {
+    return is_playoff_game;
+}
+
+float GameState::getGameTension() const {
+    return game_tension;
+}
+
+Team* GameState::getHomeTeam() const {
+    return home_team;
+}
+
+Team* GameState::getAwayTeam() const {
+    return away_team;
+}
+
+void GameState::setRivalryStatus(bool isRivalry) {
+    is_rivalry_game = isRivalry;
+    calculateGameTension();
+}
+
+void GameState::setPlayoffStatus(bool isPlayoff) {
+    is_playoff_game = isPlayoff;
+    calculateGameTension();
+}
+
+void GameState::calculateGameTension() {
+    float tension = 0.2f;
+    if (isCloseGame()) {
+        tension += 0.3f;
+    }
+    if (isLateGame()) {
+        tension += 0.3f;
+    }
+    if (is_rivalry_game) {
+        tension += 0.1f;
+    }
+    if (is_playoff_game) {
+        tension += 0.1f;
+    }
+    game_tension = std::min(1.0f, tension);
+}
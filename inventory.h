@@ -0,0 +1,745 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "inventory_digest.h"
+#include "memory_accounting.h"
+#include "name_filter.h"
+#include "name_scan.h"
+#include "sales_analytics.h"
+#include "sorted_index.h"
+#include "stock_kernels.h"
+#include "timer_wheel.h"
+
+class Item {
+private:
+    TaggedName name;
+    uint64_t name_hash;
+    int quantity;
+    float price;
+    uint64_t id;            // stable while indexes shift on erase
+    int reserved;           // held by reservations, never more than quantity
+    size_t sales_slot;      // sales history slot, assigned on the first sale
+    int reorder_point;      // low stock below this, 0 for no alerts
+
+public:
+    Item(
+            std::string name,
+            int quantity,
+            float price,
+            uint64_t id = 0
+    ) :
+            name{makeTaggedName(name)},
+            name_hash{InventoryDigest::hash_name(name.data(), name.size())},
+            quantity{quantity},
+            price{price},
+            id{id},
+            reserved{0},
+            sales_slot{SalesAnalytics::npos},
+            reorder_point{0} {
+
+    }
+
+    std::string get_name() const {
+        return toString(name);
+    }
+
+    uint64_t get_name_hash() const {
+        return name_hash;
+    }
+
+    uint64_t get_scan_key() const {
+        return NameKey::make(name.data(), name.size(), name_hash);
+    }
+
+    int get_quantity() const {
+        return quantity;
+    }
+
+    void set_quantity(int new_quantity) {
+        quantity = new_quantity;
+    }
+
+    float get_price() const {
+        return price;
+    }
+
+    uint64_t get_id() const {
+        return id;
+    }
+
+    int get_reserved() const {
+        return reserved;
+    }
+
+    void set_reserved(int new_reserved) {
+        reserved = new_reserved;
+    }
+
+    size_t get_sales_slot() const {
+        return sales_slot;
+    }
+
+    void set_sales_slot(size_t slot) {
+        sales_slot = slot;
+    }
+
+    int get_reorder_point() const {
+        return reorder_point;
+    }
+
+    void set_reorder_point(int point) {
+        reorder_point = point;
+    }
+
+    bool is_low_stock() const {
+        return quantity < reorder_point;
+    }
+
+    // what a sale or a new reservation can still take
+    int get_available() const {
+        return quantity - reserved;
+    }
+
+    bool is_match(const std::string &other) const {
+        return name.size() == other.size() &&
+               std::char_traits<char>::compare(name.data(), other.data(), name.size()) == 0;
+    }
+};
+
+enum class SaleStatus {
+    SOLD,
+    SOLD_OUT,               // sold and the item was removed at quantity 0
+    NOT_FOUND,
+    INSUFFICIENT_QUANTITY,
+    INVALID_QUANTITY
+};
+
+enum class ReserveStatus {
+    RESERVED,
+    NOT_FOUND,
+    INSUFFICIENT_QUANTITY,  // not enough stock left outside other reservations
+    INVALID_QUANTITY
+};
+
+// raised when an item's quantity drops below its reorder point, or when a
+// restocking threshold is set above the current stock
+struct StockAlert {
+    std::string name;
+    int quantity;           // 0 when the sale sold the item out
+    int reorder_point;
+};
+
+// one line of a bundle purchase
+struct BundleLine {
+    std::string name;
+    int quantity;
+};
+
+class Inventory {
+public:
+    using Clock = std::function<uint64_t()>;
+
+private:
+    struct Reservation {
+        uint64_t item_id;
+        int quantity;
+    };
+
+    using ReservationMap = std::unordered_map<uint64_t, Reservation, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                              TaggedAllocator<std::pair<const uint64_t, Reservation>,
+                                                              MemoryTag::INVENTORY_ITEMS>>;
+
+    // 10 ms ticks, one revolution every ~41 s
+    static constexpr size_t kReservationBuckets = 4096;
+    static constexpr uint64_t kReservationTickMs = 10;
+
+    TaggedVector<Item, MemoryTag::INVENTORY_ITEMS> items;
+    float total_money;
+    uint64_t next_item_id;
+    ReservationMap reservations;
+    TimerWheel reservation_wheel;
+    uint64_t next_reservation_id;
+    Clock clock;
+    SalesAnalytics sales;
+    bool sales_windows;             // bucket sales by time, which reads the clock
+    SortedIndex<float> price_index;
+    SortedIndex<int> quantity_index;
+    std::unordered_map<std::string, int> reorder_points;    // by name, so restocks inherit them
+    std::unordered_set<uint64_t> low_stock;                 // ids of items below their reorder point
+    std::deque<StockAlert> alerts;
+    InventoryDigest digest;
+    NameFilter name_filter;
+    PackedNameKeys name_keys;       // one per item, same order
+    StockColumns columns;           // one row per item, same order
+
+    static uint64_t steady_clock_ms() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // expiry reads the clock only while reservations are held. a sale reads
+    // it once more for the windowed sales history, unless that is turned off
+    void expire_due() {
+        if (!reservations.empty()) {
+            expire_reservations();
+        }
+    }
+
+    // ids are handed out in insertion order and erasing keeps the order, so
+    // items stay sorted by id
+    size_t find_item_by_id(uint64_t id) const {
+        auto found = std::lower_bound(items.begin(), items.end(), id,
+                                      [](const Item &item, uint64_t value) { return item.get_id() < value; });
+        if (found == items.end() || found->get_id() != id) {
+            return npos;
+        }
+        return static_cast<size_t>(found - items.begin());
+    }
+
+    // items of the ids an index visits, in the index's order. pointers stay
+    // valid until the next change to the inventory
+    template<typename Key>
+    std::vector<const Item *> collect(const SortedIndex<Key> &index, Key min, Key max) const {
+        std::vector<const Item *> found;
+        index.for_range(min, max, [&](Key, uint64_t id) {
+            found.push_back(&items[find_item_by_id(id)]);
+        });
+        return found;
+    }
+
+    // drops a stock line from the item list and from every view of it;
+    // indexed_quantity is the quantity the views last saw
+    void erase_at(size_t item_index, int indexed_quantity) {
+        const Item &item = items[item_index];
+        if (item.get_reorder_point() > 0) {
+            low_stock.erase(item.get_id());
+        }
+        digest.remove(item.get_name_hash(), indexed_quantity, item.get_price());
+        name_filter.remove(item.get_name_hash());
+        price_index.erase(item.get_price(), item.get_id());
+        quantity_index.erase(indexed_quantity, item.get_id());
+        items.erase(items.begin() + item_index);
+        name_keys.erase(item_index);
+        columns.erase(item_index);
+    }
+
+    // gives a reservation's hold back to the item; a reserved item always
+    // has stock, so it cannot have been erased
+    void drop_reservation(ReservationMap::iterator reservation) {
+        size_t item_index = find_item_by_id(reservation->second.item_id);
+        Item &item = items[item_index];
+        item.set_reserved(item.get_reserved() - reservation->second.quantity);
+        reservations.erase(reservation);
+    }
+
+    static void display_data(Item &item) {
+        std::cout << "\nItem name: " << item.get_name();
+        std::cout << "\nQuantity: " << item.get_quantity();
+        std::cout << "\nPrice: " << item.get_price();
+    }
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    Inventory() :
+            items{},
+            total_money{0},
+            next_item_id{1},
+            reservations{},
+            reservation_wheel{kReservationBuckets, kReservationTickMs},
+            next_reservation_id{1},
+            clock{steady_clock_ms},
+            sales{},
+            sales_windows{true},
+            price_index{},
+            quantity_index{},
+            reorder_points{},
+            low_stock{},
+            alerts{},
+            digest{},
+            name_filter{},
+            name_keys{},
+            columns{} {
+        reservation_wheel.start(clock());
+    }
+
+    // programmatic interface, shared by the menu below and by tools/services
+
+    bool add_item(std::string name, int quantity, float price) {
+        // an empty or negative stock line would be a ghost entry; a NaN
+        // price would have no place in the price order
+        if (quantity <= 0 || !(price >= 0)) {
+            return false;
+        }
+        uint64_t id = next_item_id++;
+        int reorder_point = 0;
+        if (!reorder_points.empty()) {
+            auto found = reorder_points.find(name);
+            reorder_point = found == reorder_points.end() ? 0 : found->second;
+        }
+        items.emplace_back(std::move(name), quantity, price, id);
+        name_keys.push_back(items.back().get_scan_key());
+        columns.push_back(quantity, price);
+        items.back().set_reorder_point(reorder_point);
+        digest.add(items.back().get_name_hash(), quantity, price);
+        if (items.size() > name_filter.get_capacity()) {
+            name_filter.reset(2 * items.size());
+            for (const Item &item : items) {
+                name_filter.add(item.get_name_hash());
+            }
+        } else {
+            name_filter.add(items.back().get_name_hash());
+        }
+        if (items.back().is_low_stock()) {
+            low_stock.insert(id);
+            alerts.push_back(StockAlert{items.back().get_name(), quantity, reorder_point});
+        }
+        price_index.insert(price, id);
+        quantity_index.insert(quantity, id);
+        return true;
+    }
+
+    size_t find_item(const std::string &name) const {
+        uint64_t name_hash = InventoryDigest::hash_name(name.data(), name.size());
+        // most names that are not stocked stop here, before the scan
+        if (!name_filter.may_contain(name_hash)) {
+            return npos;
+        }
+        // the packed keys settle short names outright; a long name whose key
+        // matches is checked by its full hash, then in full
+        uint64_t query = NameKey::make(name.data(), name.size(), name_hash);
+        bool exact = NameKey::is_exact(name.size());
+        for (size_t i = name_keys.find(query); i != PackedNameKeys::npos; i = name_keys.find(query, i + 1)) {
+            if (exact || (items[i].get_name_hash() == name_hash && items[i].is_match(name))) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    SaleStatus sell(const std::string &name, int quantity, float *money_earned = nullptr) {
+        size_t item_index = find_item(name);
+        if (item_index == npos) {
+            return SaleStatus::NOT_FOUND;
+        }
+        return sell_at(item_index, quantity, money_earned);
+    }
+
+    SaleStatus sell_at(size_t item_index, int sell_quantity, float *money_earned = nullptr) {
+        if (sell_quantity <= 0) {
+            return SaleStatus::INVALID_QUANTITY;
+        }
+        // expiry only changes holds, never erases, so item_index stays valid
+        expire_due();
+        Item &item = items[item_index];
+        int quantity = item.get_quantity();
+        if (sell_quantity > item.get_available()) {
+            return SaleStatus::INSUFFICIENT_QUANTITY;
+        }
+
+        float earned = item.get_price() * sell_quantity;
+        int new_quantity = quantity - sell_quantity;
+        item.set_quantity(new_quantity);
+        columns.set_quantity(item_index, new_quantity);
+        total_money += earned;
+        if (item.get_sales_slot() == SalesAnalytics::npos) {
+            item.set_sales_slot(sales.slot_for(item.get_name()));
+        }
+        if (sales_windows) {
+            sales.record_sale(item.get_sales_slot(), sell_quantity, earned, clock());
+        } else {
+            sales.record_lifetime_sale(item.get_sales_slot(), sell_quantity, earned);
+        }
+        if (money_earned != nullptr) {
+            *money_earned = earned;
+        }
+
+        // only the sale that crosses the reorder point raises an alert
+        if (new_quantity < item.get_reorder_point() && quantity >= item.get_reorder_point()) {
+            low_stock.insert(item.get_id());
+            alerts.push_back(StockAlert{item.get_name(), new_quantity, item.get_reorder_point()});
+        }
+
+        // lets remove item completely if quantity reaches 0
+        if (new_quantity == 0) {
+            erase_at(item_index, quantity);
+            return SaleStatus::SOLD_OUT;
+        }
+        quantity_index.update(quantity, new_quantity, item.get_id());
+        digest.update(item.get_name_hash(), quantity, new_quantity, item.get_price());
+        return SaleStatus::SOLD;
+    }
+
+    // takes a stock line out without selling it, e.g. to move it to another
+    // store; fails while any of it is reserved
+    bool extract_at(size_t item_index, Item *removed = nullptr) {
+        expire_due();
+        if (items[item_index].get_reserved() > 0) {
+            return false;
+        }
+        if (removed != nullptr) {
+            *removed = items[item_index];
+        }
+        erase_at(item_index, items[item_index].get_quantity());
+        return true;
+    }
+
+    // sells every line or none: all lines are validated before anything is
+    // decremented, so a failure leaves the inventory untouched. on failure
+    // failed_line names the line that could not be satisfied
+    SaleStatus sell_bundle(const std::vector<BundleLine> &lines, float *money_earned = nullptr,
+                           size_t *failed_line = nullptr) {
+        expire_due();
+        struct Take {
+            size_t item_index;
+            int quantity;
+            size_t first_line;      // the line reported if the sale fails
+        };
+        std::vector<Take> takes;
+        for (size_t i = 0; i < lines.size(); i++) {
+            SaleStatus status = SaleStatus::SOLD;
+            size_t item_index = find_item(lines[i].name);
+            if (lines[i].quantity <= 0) {
+                status = SaleStatus::INVALID_QUANTITY;
+            } else if (item_index == npos) {
+                status = SaleStatus::NOT_FOUND;
+            } else {
+                // the same item twice in a bundle has to cover the sum. the
+                // line is checked against what the earlier lines left, so a
+                // huge quantity cannot wrap the sum past the check
+                Take *take = nullptr;
+                for (Take &other : takes) {
+                    if (other.item_index == item_index) {
+                        take = &other;
+                    }
+                }
+                int left = items[item_index].get_available() - (take != nullptr ? take->quantity : 0);
+                if (lines[i].quantity > left) {
+                    status = SaleStatus::INSUFFICIENT_QUANTITY;
+                } else if (take != nullptr) {
+                    take->quantity += lines[i].quantity;
+                } else {
+                    takes.push_back(Take{item_index, lines[i].quantity, i});
+                }
+            }
+            if (status != SaleStatus::SOLD) {
+                if (failed_line != nullptr) {
+                    *failed_line = i;
+                }
+                return status;
+            }
+        }
+
+        // highest index first, so sold-out erasures do not shift the rest
+        std::sort(takes.begin(), takes.end(),
+                  [](const Take &a, const Take &b) { return a.item_index > b.item_index; });
+        float earned = 0;
+        SaleStatus result = SaleStatus::SOLD;
+        for (const Take &take : takes) {
+            float line_money = 0;
+            // every take was validated above, so this only fails if that
+            // check and sell_at disagree; report it rather than claim SOLD
+            SaleStatus status = sell_at(take.item_index, take.quantity, &line_money);
+            if (status != SaleStatus::SOLD && status != SaleStatus::SOLD_OUT) {
+                if (result == SaleStatus::SOLD && failed_line != nullptr) {
+                    *failed_line = take.first_line;
+                }
+                result = result == SaleStatus::SOLD ? status : result;
+                continue;
+            }
+            earned += line_money;
+        }
+        if (money_earned != nullptr) {
+            *money_earned = earned;
+        }
+        return result;
+    }
+
+    // holds quantity of an item for ttl_ms without selling it. held stock is
+    // not available to sales or other reservations until the reservation is
+    // completed, released, or expires
+    ReserveStatus reserve(const std::string &name, int quantity, uint64_t ttl_ms,
+                          uint64_t *reservation_id = nullptr) {
+        if (quantity <= 0 || ttl_ms == 0) {
+            return ReserveStatus::INVALID_QUANTITY;
+        }
+        uint64_t now = clock();
+        expire_reservations(now);
+        size_t item_index = find_item(name);
+        if (item_index == npos) {
+            return ReserveStatus::NOT_FOUND;
+        }
+        Item &item = items[item_index];
+        if (quantity > item.get_available()) {
+            return ReserveStatus::INSUFFICIENT_QUANTITY;
+        }
+
+        uint64_t id = next_reservation_id++;
+        item.set_reserved(item.get_reserved() + quantity);
+        reservations.emplace(id, Reservation{item.get_id(), quantity});
+        reservation_wheel.schedule(id, now + ttl_ms);
+        if (reservation_id != nullptr) {
+            *reservation_id = id;
+        }
+        return ReserveStatus::RESERVED;
+    }
+
+    // sells the held quantity; NOT_FOUND once the reservation has expired
+    // or was already completed or released
+    SaleStatus complete_reservation(uint64_t reservation_id, float *money_earned = nullptr) {
+        expire_due();
+        auto reservation = reservations.find(reservation_id);
+        if (reservation == reservations.end()) {
+            return SaleStatus::NOT_FOUND;
+        }
+        uint64_t item_id = reservation->second.item_id;
+        int quantity = reservation->second.quantity;
+        drop_reservation(reservation);
+        return sell_at(find_item_by_id(item_id), quantity, money_earned);
+    }
+
+    bool release_reservation(uint64_t reservation_id) {
+        expire_due();
+        auto reservation = reservations.find(reservation_id);
+        if (reservation == reservations.end()) {
+            return false;
+        }
+        drop_reservation(reservation);
+        return true;
+    }
+
+    // releases every reservation due at now_ms. completed and released
+    // reservations still sit in the wheel and are skipped when they come due
+    size_t expire_reservations(uint64_t now_ms) {
+        size_t expired = 0;
+        reservation_wheel.advance(now_ms, [&](uint64_t id) {
+            auto reservation = reservations.find(id);
+            if (reservation != reservations.end()) {
+                drop_reservation(reservation);
+                expired++;
+            }
+        });
+        return expired;
+    }
+
+    size_t expire_reservations() {
+        return expire_reservations(clock());
+    }
+
+    // units and revenue of an item over the last minute, hour or day
+    SalesTotals get_sales(const std::string &name, SalesWindow window) const {
+        return sales.window_totals(name, window, clock());
+    }
+
+    // off, sales keep only lifetime totals and top sellers, and never read
+    // the clock; get_sales then counts nothing sold from that point on
+    void set_sales_windows(bool enabled) {
+        sales_windows = enabled;
+    }
+
+    // best sellers by lifetime units, including items since sold out
+    std::vector<SalesTotals> get_top_sellers(size_t k) const {
+        return sales.top_sellers(k);
+    }
+
+    // replaces the millisecond clock reservations expire and sales are
+    // bucketed by; set it before the first reservation
+    void set_clock(Clock new_clock) {
+        clock = std::move(new_clock);
+        reservation_wheel.start(clock());
+    }
+
+    size_t reservation_count() const {
+        return reservations.size();
+    }
+
+    // sets the reorder point of every item with this name and of later
+    // restocks; 0 turns alerts off. stock already below it alerts at once
+    void set_reorder_point(const std::string &name, int point) {
+        point = std::max(0, point);
+        reorder_points[name] = point;
+        for (Item &item : items) {
+            if (!item.is_match(name)) {
+                continue;
+            }
+            bool was_low = item.is_low_stock();
+            item.set_reorder_point(point);
+            if (item.is_low_stock() && !was_low) {
+                low_stock.insert(item.get_id());
+                alerts.push_back(StockAlert{item.get_name(), item.get_quantity(), point});
+            } else if (!item.is_low_stock() && was_low) {
+                low_stock.erase(item.get_id());
+            }
+        }
+    }
+
+    // takes the oldest pending alert, false when there is none
+    bool poll_alert(StockAlert *alert) {
+        if (alerts.empty()) {
+            return false;
+        }
+        *alert = std::move(alerts.front());
+        alerts.pop_front();
+        return true;
+    }
+
+    size_t pending_alert_count() const {
+        return alerts.size();
+    }
+
+    // items below their reorder point, oldest first; no scan of the inventory
+    std::vector<const Item *> get_low_stock_items() const {
+        std::vector<uint64_t> ids(low_stock.begin(), low_stock.end());
+        std::sort(ids.begin(), ids.end());
+        std::vector<const Item *> low;
+        low.reserve(ids.size());
+        for (uint64_t id : ids) {
+            low.push_back(&items[find_item_by_id(id)]);
+        }
+        return low;
+    }
+
+    // merkle summary of the contents, for comparing replicas
+    const InventoryDigest &get_digest() const {
+        return digest;
+    }
+
+    // the stock lines of one digest bucket, for reconciling a bucket two
+    // replicas disagree on
+    std::vector<const Item *> get_items_in_bucket(size_t bucket) const {
+        std::vector<const Item *> found;
+        for (const Item &item : items) {
+            if (InventoryDigest::bucket_of(item.get_name_hash()) == bucket) {
+                found.push_back(&item);
+            }
+        }
+        return found;
+    }
+
+    // items priced min_price..max_price, cheapest first, without sorting
+    std::vector<const Item *> get_items_by_price(float min_price = 0,
+                                                 float max_price = std::numeric_limits<float>::max()) const {
+        return collect(price_index, min_price, max_price);
+    }
+
+    // items with min_quantity..max_quantity in stock, fewest first
+    std::vector<const Item *> get_items_by_quantity(int min_quantity = 0,
+                                                    int max_quantity = std::numeric_limits<int>::max()) const {
+        return collect(quantity_index, min_quantity, max_quantity);
+    }
+
+    // sum of quantity * price over every item, reserved stock included
+    double get_total_value() const {
+        return columns.total_value();
+    }
+
+    // sets bit i of the bitmap (word i / 64) for each item index i with
+    // fewer than limit in stock; returns how many were selected
+    size_t select_quantity_below(int limit, std::vector<uint64_t> *bitmap) const {
+        return columns.select_quantity_below(limit, bitmap);
+    }
+
+    // same, for items priced min_price..max_price
+    size_t select_price_between(float min_price, float max_price, std::vector<uint64_t> *bitmap) const {
+        return columns.select_price_between(min_price, max_price, bitmap);
+    }
+
+    const TaggedVector<Item, MemoryTag::INVENTORY_ITEMS> &get_items() const {
+        return items;
+    }
+
+    size_t item_count() const {
+        return items.size();
+    }
+
+    float get_total_money() const {
+        return total_money;
+    }
+
+    // interactive menu actions
+
+    void add_item() {
+        std::string name;
+        int quantity;
+        float price;
+
+        std::cin.ignore();
+        std::cout << "\nEnter item name: ";
+        std::cin >> name;
+        std::cout << "Enter quantity: ";
+        std::cin >> quantity;
+        std::cout << "Enter price: ";
+        std::cin >> price;
+
+        if (!add_item(name, quantity, price)) {
+            std::cout << "\nQuantity must be positive and price not negative.";
+        }
+    }
+
+    void sell_item() {
+        std::string item_to_check;
+        std::cin.ignore();
+        std::cout << "\nEnter item name: ";
+        std::cin >> item_to_check;
+
+        size_t item_index = find_item(item_to_check);
+        if (item_index != npos) {
+            remove_item(item_index);
+            return;
+        }
+        std::cout << "\nThis item is not in your Inventory";
+    }
+
+    void remove_item(size_t item_index) {
+        int input_quantity;
+        std::cout << "\nEnter number of items to sell: ";
+        std::cin >> input_quantity;
+
+        float money_earned = 0;
+        SaleStatus status = sell_at(item_index, input_quantity, &money_earned);
+        if (status == SaleStatus::INSUFFICIENT_QUANTITY) {
+            std::cout << "\nCannot sell more items than you have.";
+            return;
+        }
+        if (status == SaleStatus::INVALID_QUANTITY) {
+            std::cout << "\nNumber of items to sell must be positive.";
+            return;
+        }
+
+        std::cout << "\nItems sold";
+        std::cout << "\nMoney received: " << money_earned;
+        if (status == SaleStatus::SOLD_OUT) {
+            std::cout << "\nItem completely removed from inventory.";
+        } else if (items[item_index].is_low_stock()) {
+            std::cout << "\nStock is below its reorder point.";
+        }
+    }
+
+    void list_items() {
+        if (items.empty()) {
+            std::cout << "\nInventory empty.";
+            return;
+        }
+
+        for (size_t i = 0; i < items.size(); i++) {
+            display_data(items[i]);
+            std::cout << "\n";
+        }
+    }
+};
+
+#endif
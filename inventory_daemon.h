@@ -0,0 +1,300 @@
+#ifndef INVENTORY_DAEMON_H
+#define INVENTORY_DAEMON_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "inventory_service.h"
+
+// single-threaded event loop serving an InventoryService to local clients,
+// over a Unix stream socket or a pair of pipes.
+//
+// every connection is non-blocking. when one turns readable the loop reads
+// all it can (up to kReadBudget per turn), runs every complete request in it
+// as one batch and queues the batch's responses. queued response buffers go
+// out with writev, as many per call as the kernel takes, resuming from a
+// partial write on the next POLLOUT. a client that stops reading stops
+// being read from once kMaxQueuedBytes are waiting for it, so a flood of
+// pipelined requests cannot grow the queue without bound. a connection is
+// closed when its peer hangs up (after its last responses are flushed), on
+// an I/O error, or on a frame longer than the protocol allows. the process
+// should ignore SIGPIPE, so a vanished client shows up as a write error.
+class InventoryDaemon {
+private:
+    static constexpr size_t kReadChunk = 64 * 1024;
+    static constexpr size_t kReadBudget = 1024 * 1024;
+    static constexpr size_t kMaxQueuedBytes = 4 * 1024 * 1024;
+    static constexpr int kMaxIovecs = 64;
+    static constexpr int kPollTimeoutMs = 100;
+
+    struct Connection {
+        int in_fd;
+        int out_fd;
+        std::vector<uint8_t> input;
+        std::deque<std::vector<uint8_t>> output;
+        size_t output_offset;   // bytes of output.front() already written
+        size_t queued_bytes;
+        bool peer_closed;
+        bool failed;
+    };
+
+    InventoryService service;
+    std::string socket_path;
+    int listen_fd;
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::atomic<bool> stopping;
+    uint64_t batches;
+    uint64_t requests;
+
+    static bool set_non_blocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void accept_all() {
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            if (!add_connection(fd, fd)) {
+                close(fd);
+            }
+        }
+    }
+
+    void read_input(Connection &connection) {
+        size_t budget = kReadBudget;
+        while (budget > 0 && connection.queued_bytes < kMaxQueuedBytes) {
+            size_t used = connection.input.size();
+            connection.input.resize(used + kReadChunk);
+            ssize_t got = read(connection.in_fd, connection.input.data() + used, kReadChunk);
+            connection.input.resize(used + (got > 0 ? static_cast<size_t>(got) : 0));
+            if (got == 0) {
+                connection.peer_closed = true;
+                break;
+            }
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                connection.failed = errno != EAGAIN && errno != EWOULDBLOCK;
+                break;
+            }
+            budget -= std::min(budget, static_cast<size_t>(got));
+        }
+        if (connection.input.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> responses;
+        size_t consumed = service.handle_batch(connection.input.data(), connection.input.size(), &responses);
+        if (consumed == InventoryService::npos) {
+            connection.failed = true;
+            return;
+        }
+        connection.input.erase(connection.input.begin(), connection.input.begin() + static_cast<long>(consumed));
+        if (!responses.empty()) {
+            batches++;
+            requests += responses.size() / ServiceProtocol::kResponseBytes;
+            connection.queued_bytes += responses.size();
+            connection.output.push_back(std::move(responses));
+        }
+    }
+
+    void flush_output(Connection &connection) {
+        while (!connection.output.empty()) {
+            iovec vectors[kMaxIovecs];
+            int count = 0;
+            for (auto buffer = connection.output.begin(); buffer != connection.output.end() && count < kMaxIovecs;
+                 ++buffer, ++count) {
+                size_t skip = count == 0 ? connection.output_offset : 0;
+                vectors[count].iov_base = buffer->data() + skip;
+                vectors[count].iov_len = buffer->size() - skip;
+            }
+            ssize_t wrote = writev(connection.out_fd, vectors, count);
+            if (wrote < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                connection.failed = errno != EAGAIN && errno != EWOULDBLOCK;
+                return;
+            }
+            size_t left = static_cast<size_t>(wrote);
+            connection.queued_bytes -= left;
+            while (left > 0) {
+                size_t rest = connection.output.front().size() - connection.output_offset;
+                if (left < rest) {
+                    connection.output_offset += left;
+                    break;
+                }
+                left -= rest;
+                connection.output.pop_front();
+                connection.output_offset = 0;
+            }
+        }
+    }
+
+    static void close_connection(Connection &connection) {
+        close(connection.in_fd);
+        if (connection.out_fd != connection.in_fd) {
+            close(connection.out_fd);
+        }
+    }
+
+public:
+    InventoryDaemon() :
+            service{},
+            socket_path{},
+            listen_fd{-1},
+            connections{},
+            stopping{false},
+            batches{0},
+            requests{0} {
+
+    }
+
+    InventoryDaemon(const InventoryDaemon &) = delete;
+    InventoryDaemon &operator=(const InventoryDaemon &) = delete;
+
+    ~InventoryDaemon() {
+        for (const auto &connection : connections) {
+            close_connection(*connection);
+        }
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            unlink(socket_path.c_str());
+        }
+    }
+
+    // listens on a Unix stream socket at path, replacing a stale one
+    bool listen_on(const std::string &path) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0 ||
+            !set_non_blocking(fd)) {
+            close(fd);
+            return false;
+        }
+        listen_fd = fd;
+        socket_path = path;
+        return true;
+    }
+
+    // serves one connection over an already open pair of descriptors (the
+    // same one twice for a socket); the daemon closes them when done
+    bool add_connection(int in_fd, int out_fd) {
+        if (!set_non_blocking(in_fd) || !set_non_blocking(out_fd)) {
+            return false;
+        }
+        connections.push_back(std::unique_ptr<Connection>(
+                new Connection{in_fd, out_fd, {}, {}, 0, 0, false, false}));
+        return true;
+    }
+
+    // serves until stop() is called or, without a listening socket, until
+    // every connection has closed. returns false on a poll failure
+    bool run() {
+        std::vector<pollfd> polled;
+        std::vector<Connection *> owners;     // per entry of polled, nullptr for the listening socket
+        while (!stopping.load(std::memory_order_relaxed) && (listen_fd >= 0 || !connections.empty())) {
+            polled.clear();
+            owners.clear();
+            if (listen_fd >= 0) {
+                polled.push_back(pollfd{listen_fd, POLLIN, 0});
+                owners.push_back(nullptr);
+            }
+            for (const auto &connection : connections) {
+                short in_events = !connection->peer_closed && connection->queued_bytes < kMaxQueuedBytes ? POLLIN : 0;
+                short out_events = connection->output.empty() ? 0 : POLLOUT;
+                if (connection->in_fd == connection->out_fd) {
+                    polled.push_back(pollfd{connection->in_fd, static_cast<short>(in_events | out_events), 0});
+                    owners.push_back(connection.get());
+                } else {
+                    polled.push_back(pollfd{connection->in_fd, in_events, 0});
+                    owners.push_back(connection.get());
+                    polled.push_back(pollfd{connection->out_fd, out_events, 0});
+                    owners.push_back(connection.get());
+                }
+            }
+            int ready = poll(polled.data(), polled.size(), kPollTimeoutMs);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            for (size_t i = 0; i < polled.size(); i++) {
+                short events = polled[i].revents;
+                if (events == 0) {
+                    continue;
+                }
+                if (owners[i] == nullptr) {
+                    accept_all();
+                    continue;
+                }
+                Connection &connection = *owners[i];
+                if (polled[i].fd == connection.in_fd && (events & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                    read_input(connection);
+                }
+                // answer right away: most of the time the socket has room
+                // and the responses leave without another poll round
+                flush_output(connection);
+            }
+            connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                             [](const std::unique_ptr<Connection> &connection) {
+                                                 bool done = connection->failed ||
+                                                             (connection->peer_closed && connection->output.empty());
+                                                 if (done) {
+                                                     close_connection(*connection);
+                                                 }
+                                                 return done;
+                                             }),
+                              connections.end());
+        }
+        return true;
+    }
+
+    // safe to call from a signal handler or another thread
+    void stop() {
+        stopping.store(true, std::memory_order_relaxed);
+    }
+
+    const Inventory &get_inventory() const {
+        return service.get_inventory();
+    }
+
+    uint64_t batch_count() const {
+        return batches;
+    }
+
+    uint64_t request_count() const {
+        return requests;
+    }
+};
+
+#endif
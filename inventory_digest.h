@@ -0,0 +1,143 @@
+#ifndef INVENTORY_DIGEST_H
+#define INVENTORY_DIGEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "memory_accounting.h"
+
+// merkle summary of inventory contents, for checking replicas against each
+// other.
+//
+// items fall into a fixed number of buckets by a hash of their name. a
+// bucket's hash is the sum of its item hashes, so adding or removing one
+// item is an add or a subtract with no need to see the rest of the bucket,
+// and identical items (duplicate stock lines) do not cancel out. the
+// buckets are the leaves of a binary tree whose nodes hash their two
+// children, so each change rehashes one path to the root. two replicas
+// agree when their roots agree; otherwise they descend only into subtrees
+// whose hashes differ, which finds the differing buckets by exchanging a
+// few hashes per difference instead of every item.
+//
+// names are hashed with FNV-1a rather than std::hash so that replicas built
+// differently still agree.
+class InventoryDigest {
+private:
+    // nodes[1] is the root, node i has children 2i and 2i + 1, and bucket b
+    // is node kBucketCount + b
+    TaggedVector<uint64_t, MemoryTag::INVENTORY_ITEMS> nodes;
+
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // ordered, so swapping two subtrees changes the parent
+    static uint64_t combine(uint64_t left, uint64_t right) {
+        return mix(left ^ mix(right + 0x9e3779b97f4a7c15ULL));
+    }
+
+    void rehash_path(size_t node) {
+        for (node /= 2; node > 0; node /= 2) {
+            nodes[node] = combine(nodes[2 * node], nodes[2 * node + 1]);
+        }
+    }
+
+public:
+    static constexpr size_t kBucketCount = 1024;
+
+    InventoryDigest() :
+            nodes(2 * kBucketCount, 0) {
+        for (size_t node = kBucketCount - 1; node > 0; node--) {
+            nodes[node] = combine(nodes[2 * node], nodes[2 * node + 1]);
+        }
+    }
+
+    static uint64_t hash_name(const char *name, size_t length) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<unsigned char>(name[i]);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    static size_t bucket_of(uint64_t name_hash) {
+        return static_cast<size_t>(mix(name_hash) % kBucketCount);
+    }
+
+    // one stock line: name, quantity and price all count
+    static uint64_t hash_item(uint64_t name_hash, int quantity, float price) {
+        uint32_t price_bits;
+        static_assert(sizeof(price_bits) == sizeof(price), "float is 32 bits");
+        std::memcpy(&price_bits, &price, sizeof(price));
+        return mix(name_hash ^ mix((static_cast<uint64_t>(static_cast<uint32_t>(quantity)) << 32) | price_bits));
+    }
+
+    void add(uint64_t name_hash, int quantity, float price) {
+        size_t node = kBucketCount + bucket_of(name_hash);
+        nodes[node] += hash_item(name_hash, quantity, price);
+        rehash_path(node);
+    }
+
+    void remove(uint64_t name_hash, int quantity, float price) {
+        size_t node = kBucketCount + bucket_of(name_hash);
+        nodes[node] -= hash_item(name_hash, quantity, price);
+        rehash_path(node);
+    }
+
+    // a quantity change is one path update, not two
+    void update(uint64_t name_hash, int old_quantity, int new_quantity, float price) {
+        size_t node = kBucketCount + bucket_of(name_hash);
+        nodes[node] += hash_item(name_hash, new_quantity, price) - hash_item(name_hash, old_quantity, price);
+        rehash_path(node);
+    }
+
+    uint64_t root() const {
+        return nodes[1];
+    }
+
+    // what a replica sends when asked about one node
+    uint64_t node_hash(size_t node) const {
+        return nodes[node];
+    }
+
+    static size_t node_count() {
+        return 2 * kBucketCount;
+    }
+
+    // buckets whose contents differ from other's, walking down from the
+    // root through differing nodes only. hashes_compared counts the node
+    // hashes a remote replica would have had to send
+    std::vector<size_t> diff(const InventoryDigest &other, size_t *hashes_compared = nullptr) const {
+        std::vector<size_t> buckets;
+        std::vector<size_t> pending{1};
+        size_t compared = 0;
+        while (!pending.empty()) {
+            size_t node = pending.back();
+            pending.pop_back();
+            compared++;
+            if (nodes[node] == other.nodes[node]) {
+                continue;
+            }
+            if (node >= kBucketCount) {
+                buckets.push_back(node - kBucketCount);
+            } else {
+                pending.push_back(2 * node + 1);
+                pending.push_back(2 * node);
+            }
+        }
+        if (hashes_compared != nullptr) {
+            *hashes_compared = compared;
+        }
+        return buckets;
+    }
+};
+
+#endif
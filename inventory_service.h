@@ -0,0 +1,258 @@
+#ifndef INVENTORY_SERVICE_H
+#define INVENTORY_SERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "inventory.h"
+
+// binary request/response protocol of the inventory daemon.
+//
+// every frame starts with a 4-byte length of the rest of the frame, so a
+// reader can split a byte stream into frames without understanding them.
+// requests: request id (u32), op (u8), 3 reserved bytes, quantity (i32),
+// price (f32), then the item name up to the end of the frame. responses are
+// always 20 bytes: length 16, the request id, status (u8), the op (u8), 2
+// reserved bytes and two 4-byte result fields:
+//
+//   ADD_ITEM    item count (u32), unused
+//   SELL        money earned (f32), quantity left (i32)
+//   GET_ITEM    quantity (i32), price (f32)
+//   GET_TOTALS  total money (f32), item count (u32)
+//
+// fields are in host byte order: the daemon only serves local clients.
+// responses come back in request order, so a client can keep many requests
+// in flight and match them up by id or by position.
+enum class ServiceOp : uint8_t {
+    ADD_ITEM = 1,
+    SELL,
+    GET_ITEM,
+    GET_TOTALS
+};
+
+enum class ServiceStatus : uint8_t {
+    OK,
+    SOLD_OUT,               // sold and the item was removed at quantity 0
+    NOT_FOUND,
+    INSUFFICIENT_QUANTITY,
+    INVALID_QUANTITY,       // also a rejected add
+    BAD_REQUEST
+};
+
+struct ServiceRequest {
+    uint32_t id;
+    ServiceOp op;
+    int quantity;
+    float price;
+    std::string name;
+};
+
+struct ServiceResponse {
+    uint32_t id;
+    ServiceStatus status;
+    ServiceOp op;
+    uint32_t first;         // raw result fields, see the table above
+    uint32_t second;
+
+    float money() const {
+        float value;
+        std::memcpy(&value, &first, sizeof(value));
+        return value;
+    }
+};
+
+struct ServiceProtocol {
+    static constexpr size_t kLengthBytes = 4;
+    static constexpr size_t kRequestHeaderBytes = 20;     // length through price
+    static constexpr size_t kResponseBytes = 20;
+    static constexpr size_t kMaxFrameBytes = 64 * 1024;
+
+    template<typename Bytes>
+    static void put_u32(Bytes &out, uint32_t value) {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &value, sizeof(bytes));
+        out.insert(out.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    static uint32_t get_u32(const uint8_t *in) {
+        uint32_t value;
+        std::memcpy(&value, in, sizeof(value));
+        return value;
+    }
+
+    static uint32_t float_bits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static float bits_float(uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // the wire status of an Inventory sale
+    static ServiceStatus status_of(SaleStatus status) {
+        switch (status) {
+            case SaleStatus::SOLD:
+                return ServiceStatus::OK;
+            case SaleStatus::SOLD_OUT:
+                return ServiceStatus::SOLD_OUT;
+            case SaleStatus::NOT_FOUND:
+                return ServiceStatus::NOT_FOUND;
+            case SaleStatus::INSUFFICIENT_QUANTITY:
+                return ServiceStatus::INSUFFICIENT_QUANTITY;
+            case SaleStatus::INVALID_QUANTITY:
+                break;
+        }
+        return ServiceStatus::INVALID_QUANTITY;
+    }
+
+    template<typename Bytes>
+    static void append_request(Bytes &out, const ServiceRequest &request) {
+        put_u32(out, static_cast<uint32_t>(kRequestHeaderBytes - kLengthBytes + request.name.size()));
+        put_u32(out, request.id);
+        const uint8_t op[4] = {static_cast<uint8_t>(request.op), 0, 0, 0};
+        out.insert(out.end(), op, op + sizeof(op));
+        put_u32(out, static_cast<uint32_t>(request.quantity));
+        put_u32(out, float_bits(request.price));
+        out.insert(out.end(), request.name.begin(), request.name.end());
+    }
+
+    template<typename Bytes>
+    static void append_response(Bytes &out, uint32_t id, ServiceStatus status, ServiceOp op, uint32_t first,
+                                uint32_t second) {
+        put_u32(out, static_cast<uint32_t>(kResponseBytes - kLengthBytes));
+        put_u32(out, id);
+        const uint8_t tag[4] = {static_cast<uint8_t>(status), static_cast<uint8_t>(op), 0, 0};
+        out.insert(out.end(), tag, tag + sizeof(tag));
+        put_u32(out, first);
+        put_u32(out, second);
+    }
+
+    // length of the frame starting at data, 0 while its length prefix is
+    // incomplete; longer than kMaxFrameBytes means the stream is broken
+    static size_t frame_size(const uint8_t *data, size_t size) {
+        if (size < kLengthBytes) {
+            return 0;
+        }
+        return kLengthBytes + get_u32(data);
+    }
+
+    // parses one response frame; false while it is incomplete
+    static bool parse_response(const uint8_t *data, size_t size, ServiceResponse *response) {
+        if (size < kResponseBytes) {
+            return false;
+        }
+        response->id = get_u32(data + 4);
+        response->status = static_cast<ServiceStatus>(data[8]);
+        response->op = static_cast<ServiceOp>(data[9]);
+        response->first = get_u32(data + 12);
+        response->second = get_u32(data + 16);
+        return true;
+    }
+};
+
+// executes request frames against one Inventory. a connection hands over
+// everything it has read; every complete frame in it runs as one batch, in
+// order, and the responses come back as one buffer, so a pipelining client
+// costs one read and one write per batch instead of per request.
+class InventoryService {
+private:
+    Inventory inventory;
+
+    void execute(const uint8_t *frame, size_t size, std::vector<uint8_t> &out) {
+        uint32_t id = ServiceProtocol::get_u32(frame + 4);
+        ServiceOp op = static_cast<ServiceOp>(frame[8]);
+        if (size < ServiceProtocol::kRequestHeaderBytes) {
+            ServiceProtocol::append_response(out, id, ServiceStatus::BAD_REQUEST, op, 0, 0);
+            return;
+        }
+        int quantity = static_cast<int>(ServiceProtocol::get_u32(frame + 12));
+        float price = ServiceProtocol::bits_float(ServiceProtocol::get_u32(frame + 16));
+        const char *name = reinterpret_cast<const char *>(frame + ServiceProtocol::kRequestHeaderBytes);
+        size_t name_length = size - ServiceProtocol::kRequestHeaderBytes;
+
+        switch (op) {
+            case ServiceOp::ADD_ITEM: {
+                bool added = inventory.add_item(std::string(name, name_length), quantity, price);
+                ServiceProtocol::append_response(out, id, added ? ServiceStatus::OK : ServiceStatus::INVALID_QUANTITY,
+                                                 op, static_cast<uint32_t>(inventory.item_count()), 0);
+                return;
+            }
+            case ServiceOp::SELL: {
+                size_t item_index = inventory.find_item(std::string(name, name_length));
+                if (item_index == Inventory::npos) {
+                    ServiceProtocol::append_response(out, id, ServiceStatus::NOT_FOUND, op, 0, 0);
+                    return;
+                }
+                float earned = 0;
+                SaleStatus status = inventory.sell_at(item_index, quantity, &earned);
+                int left = status == SaleStatus::SOLD_OUT ? 0 : inventory.get_items()[item_index].get_quantity();
+                ServiceProtocol::append_response(out, id, ServiceProtocol::status_of(status), op,
+                                                 ServiceProtocol::float_bits(earned), static_cast<uint32_t>(left));
+                return;
+            }
+            case ServiceOp::GET_ITEM: {
+                size_t item_index = inventory.find_item(std::string(name, name_length));
+                if (item_index == Inventory::npos) {
+                    ServiceProtocol::append_response(out, id, ServiceStatus::NOT_FOUND, op, 0, 0);
+                    return;
+                }
+                const Item &item = inventory.get_items()[item_index];
+                ServiceProtocol::append_response(out, id, ServiceStatus::OK, op,
+                                                 static_cast<uint32_t>(item.get_quantity()),
+                                                 ServiceProtocol::float_bits(item.get_price()));
+                return;
+            }
+            case ServiceOp::GET_TOTALS:
+                ServiceProtocol::append_response(out, id, ServiceStatus::OK, op,
+                                                 ServiceProtocol::float_bits(inventory.get_total_money()),
+                                                 static_cast<uint32_t>(inventory.item_count()));
+                return;
+        }
+        ServiceProtocol::append_response(out, id, ServiceStatus::BAD_REQUEST, op, 0, 0);
+    }
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    InventoryService() :
+            inventory{} {
+
+    }
+
+    // runs every complete frame in data[0..size) and appends its response
+    // to out. returns the bytes consumed (the rest is an incomplete frame to
+    // hand over again with more data), or npos when a frame is longer than
+    // kMaxFrameBytes and the connection should be dropped
+    size_t handle_batch(const uint8_t *data, size_t size, std::vector<uint8_t> *out) {
+        size_t consumed = 0;
+        while (true) {
+            size_t frame = ServiceProtocol::frame_size(data + consumed, size - consumed);
+            if (frame > ServiceProtocol::kMaxFrameBytes) {
+                return npos;
+            }
+            if (frame == 0 || frame > size - consumed) {
+                return consumed;
+            }
+            // a frame too short to carry an op is still answered, as id 0
+            if (frame < 9) {
+                ServiceProtocol::append_response(*out, 0, ServiceStatus::BAD_REQUEST, ServiceOp{}, 0, 0);
+            } else {
+                execute(data + consumed, frame, *out);
+            }
+            consumed += frame;
+        }
+    }
+
+    const Inventory &get_inventory() const {
+        return inventory;
+    }
+};
+
+#endif
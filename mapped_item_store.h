@@ -0,0 +1,609 @@
+#ifndef MAPPED_ITEM_STORE_H
+#define MAPPED_ITEM_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "inventory.h"
+#include "memory_accounting.h"
+
+// memory-mapped, append-only item storage for a store server.
+//
+// two files: <path> holds a header and fixed-size item records, <path>.names
+// the string heap the records point into. both are mapped shared, so the
+// records are read in place (no load or deserialization step) and a
+// restarted server continues from exactly the state the last one left.
+//
+// every mutation goes through a one-entry redo log in the header: the new
+// values are written to the log, the log is committed with a single store,
+// the values are applied, and the log is cleared. open() replays a committed
+// log, so a process killed at any point leaves a consistent store. power
+// loss is covered only in durable mode, which msyncs each step before the
+// next; otherwise call sync() at the points that must survive it.
+//
+// names are found through an in-memory hash index over the records, built
+// on open and kept in step by add and sell. it is not persisted.
+class MappedItemStore {
+private:
+    static constexpr uint64_t magic = 0x4d4f4d54534b4931ull;   // "1IKSTMOM"
+    static constexpr uint32_t format_version = 2;
+    static constexpr uint32_t initial_records = 1024;
+    static constexpr uint64_t initial_heap = 64 * 1024;
+
+    enum : uint32_t {
+        SLOT_FREE = 0,
+        SLOT_LIVE = 1
+    };
+
+    enum : uint32_t {
+        OP_NONE = 0,
+        OP_ADD,
+        OP_SELL
+    };
+
+    struct StoredItem {
+        uint64_t name_offset;       // heaps past 4 GiB stay addressable
+        uint32_t name_length;
+        uint32_t name_capacity;     // heap bytes owned, reused by a later add
+        int32_t quantity;
+        float price;
+        uint32_t state;
+        uint32_t next_free;
+    };
+
+    static_assert(sizeof(StoredItem) == 32, "records are 32 bytes on disk");
+
+    struct PendingOp {
+        uint32_t op;
+        uint32_t slot;
+        int32_t quantity;
+        float price;
+        float total_money;
+        uint32_t name_length;
+        uint64_t name_offset;
+        uint32_t name_capacity;
+        uint32_t reserved;
+    };
+
+    // one name index bucket: a live slot and the low half of its name hash
+    struct IndexEntry {
+        uint32_t slot;
+        uint32_t hash_tag;
+    };
+
+    struct StoreHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t record_capacity;
+        uint32_t record_count;      // high-water mark of used slots
+        uint32_t free_head;
+        uint32_t live_count;
+        float total_money;
+        uint64_t heap_size;
+        uint64_t heap_capacity;
+        PendingOp pending;
+    };
+
+    std::string path;
+    int record_fd;
+    int heap_fd;
+    StoreHeader *header;
+    StoredItem *records;
+    char *heap;
+    size_t record_bytes;
+    size_t heap_bytes;
+    bool durable;
+    TaggedVector<IndexEntry, MemoryTag::INVENTORY_ITEMS> name_index;
+    size_t index_used;
+
+    static size_t record_file_size(uint32_t capacity) {
+        return sizeof(StoreHeader) + static_cast<size_t>(capacity) * sizeof(StoredItem);
+    }
+
+    bool map_records(size_t bytes) {
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, record_fd, 0);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        record_bytes = bytes;
+        header = static_cast<StoreHeader *>(mapping);
+        records = reinterpret_cast<StoredItem *>(static_cast<char *>(mapping) + sizeof(StoreHeader));
+        return true;
+    }
+
+    bool map_heap(uint64_t bytes) {
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, heap_fd, 0);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        heap = static_cast<char *>(mapping);
+        heap_bytes = bytes;
+        return true;
+    }
+
+    bool grow_records() {
+        const uint32_t capacity = header->record_capacity * 2;
+        const size_t bytes = record_file_size(capacity);
+        if (ftruncate(record_fd, static_cast<off_t>(bytes)) != 0) {
+            return false;
+        }
+        munmap(header, record_bytes);
+        if (!map_records(bytes)) {
+            header = nullptr;
+            return false;
+        }
+        header->record_capacity = capacity;
+        return true;
+    }
+
+    bool grow_heap(uint64_t needed) {
+        uint64_t capacity = header->heap_capacity;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        if (capacity == header->heap_capacity) {
+            return true;
+        }
+        if (ftruncate(heap_fd, static_cast<off_t>(capacity)) != 0) {
+            return false;
+        }
+        munmap(heap, heap_bytes);
+        if (!map_heap(capacity)) {
+            heap = nullptr;
+            return false;
+        }
+        header->heap_capacity = capacity;
+        return true;
+    }
+
+    // msyncs the pages covering [address, address + length)
+    static void flush(const void *address, size_t length) {
+        static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(address) & ~(page - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(address) + length;
+        msync(reinterpret_cast<void *>(begin), end - begin, MS_SYNC);
+    }
+
+    // the commit point: one aligned 4-byte store makes the logged op durable
+    void commit(uint32_t op) {
+        __atomic_store_n(&header->pending.op, op, __ATOMIC_RELEASE);
+    }
+
+    void retire() {
+        __atomic_store_n(&header->pending.op, static_cast<uint32_t>(OP_NONE), __ATOMIC_RELEASE);
+    }
+
+    // applies the logged op; safe to run again after a crash part way through
+    void apply_pending() {
+        const PendingOp &p = header->pending;
+        StoredItem &record = records[p.slot];
+        if (p.op == OP_ADD) {
+            if (record.state == SLOT_LIVE) {
+                return;
+            }
+            if (header->free_head == p.slot) {
+                header->free_head = record.next_free;
+            }
+            if (p.slot >= header->record_count) {
+                header->record_count = p.slot + 1;
+            }
+            if (p.name_offset + p.name_capacity > header->heap_size) {
+                header->heap_size = p.name_offset + p.name_capacity;
+            }
+            record.name_offset = p.name_offset;
+            record.name_length = p.name_length;
+            record.name_capacity = p.name_capacity;
+            record.quantity = p.quantity;
+            record.price = p.price;
+            __atomic_store_n(&record.state, static_cast<uint32_t>(SLOT_LIVE), __ATOMIC_RELEASE);
+            header->live_count++;
+        } else if (p.op == OP_SELL) {
+            record.quantity = p.quantity;
+            header->total_money = p.total_money;
+            if (p.quantity == 0 && record.state == SLOT_LIVE) {
+                // lets remove item completely if quantity reaches 0
+                if (header->free_head != p.slot) {
+                    record.next_free = header->free_head;
+                    header->free_head = p.slot;
+                }
+                __atomic_store_n(&record.state, static_cast<uint32_t>(SLOT_FREE), __ATOMIC_RELEASE);
+                header->live_count--;
+            }
+        }
+    }
+
+    // commits, applies and retires the logged op. in durable mode each step
+    // reaches the disk before the next starts: the log before its commit,
+    // the commit before the apply, the applied record before the retire,
+    // and the retire before the next op rewrites the log
+    void run_logged(uint32_t op) {
+        const uint32_t slot = header->pending.slot;
+        if (durable) {
+            flush(header, sizeof(StoreHeader));
+        }
+        commit(op);
+        if (durable) {
+            flush(&header->pending.op, sizeof(uint32_t));
+        }
+        apply_pending();
+        if (durable) {
+            flush(&records[slot], sizeof(StoredItem));
+        }
+        retire();
+        if (durable) {
+            flush(header, sizeof(StoreHeader));
+        }
+    }
+
+    static uint64_t hash_of(const char *name, size_t length) {
+        return InventoryDigest::hash_name(name, length);
+    }
+
+    size_t index_bucket(uint64_t name_hash) const {
+        return static_cast<size_t>(name_hash) & (name_index.size() - 1);
+    }
+
+    void index_insert(uint32_t slot, uint64_t name_hash) {
+        if ((index_used + 1) * 4 > name_index.size() * 3) {
+            // slot is live by now, so the rebuild places it too
+            rebuild_index(2 * name_index.size());
+            return;
+        }
+        index_place(slot, name_hash);
+    }
+
+    void index_place(uint32_t slot, uint64_t name_hash) {
+        size_t bucket = index_bucket(name_hash);
+        while (name_index[bucket].slot != npos) {
+            bucket = (bucket + 1) & (name_index.size() - 1);
+        }
+        name_index[bucket] = IndexEntry{slot, static_cast<uint32_t>(name_hash)};
+        index_used++;
+    }
+
+    // linear probing, so the entries after the hole shift back into it
+    void index_erase(uint32_t slot, uint64_t name_hash) {
+        const size_t mask = name_index.size() - 1;
+        size_t hole = index_bucket(name_hash);
+        while (name_index[hole].slot != slot) {
+            if (name_index[hole].slot == npos) {
+                return;
+            }
+            hole = (hole + 1) & mask;
+        }
+        for (size_t next = (hole + 1) & mask; name_index[next].slot != npos; next = (next + 1) & mask) {
+            size_t home = static_cast<size_t>(name_index[next].hash_tag) & mask;
+            // next may move into the hole only if its home is not inside (hole, next]
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                name_index[hole] = name_index[next];
+                hole = next;
+            }
+        }
+        name_index[hole].slot = npos;
+        index_used--;
+    }
+
+    void rebuild_index(size_t buckets) {
+        size_t size = 16;
+        while (size < buckets) {
+            size *= 2;
+        }
+        name_index.assign(size, IndexEntry{npos, 0});
+        index_used = 0;
+        for (uint32_t slot = 0; slot < header->record_count; slot++) {
+            if (records[slot].state == SLOT_LIVE) {
+                index_place(slot, hash_of(heap + records[slot].name_offset, records[slot].name_length));
+            }
+        }
+    }
+
+    // a crash between apply and retire can leave live_count off by one
+    void recount_live() {
+        uint32_t live = 0;
+        for (uint32_t slot = 0; slot < header->record_count; slot++) {
+            live += records[slot].state == SLOT_LIVE ? 1 : 0;
+        }
+        header->live_count = live;
+    }
+
+    bool initialize_files() {
+        if (ftruncate(record_fd, static_cast<off_t>(record_file_size(initial_records))) != 0 ||
+            ftruncate(heap_fd, static_cast<off_t>(initial_heap)) != 0) {
+            return false;
+        }
+        if (!map_records(record_file_size(initial_records)) || !map_heap(initial_heap)) {
+            return false;
+        }
+        std::memset(header, 0, sizeof(StoreHeader));
+        header->version = format_version;
+        header->record_capacity = initial_records;
+        header->free_head = npos;
+        header->heap_capacity = initial_heap;
+        // the magic goes last, so a half-created store is recreated next time
+        __atomic_store_n(&header->magic, magic, __ATOMIC_RELEASE);
+        return true;
+    }
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    MappedItemStore() :
+            path{},
+            record_fd{-1},
+            heap_fd{-1},
+            header{nullptr},
+            records{nullptr},
+            heap{nullptr},
+            record_bytes{0},
+            heap_bytes{0},
+            durable{false},
+            name_index{},
+            index_used{0} {
+
+    }
+
+    MappedItemStore(const MappedItemStore &) = delete;
+    MappedItemStore &operator=(const MappedItemStore &) = delete;
+
+    ~MappedItemStore() {
+        close();
+    }
+
+    // opens or creates the store at path; false if the files cannot be
+    // mapped or belong to a different format
+    bool open(const std::string &store_path) {
+        close();
+        path = store_path;
+        record_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        heap_fd = ::open((path + ".names").c_str(), O_RDWR | O_CREAT, 0644);
+        if (record_fd < 0 || heap_fd < 0) {
+            close();
+            return false;
+        }
+
+        struct stat record_stat;
+        struct stat heap_stat;
+        if (fstat(record_fd, &record_stat) != 0 || fstat(heap_fd, &heap_stat) != 0) {
+            close();
+            return false;
+        }
+        if (static_cast<size_t>(record_stat.st_size) < sizeof(StoreHeader)) {
+            if (!initialize_files()) {
+                close();
+                return false;
+            }
+            rebuild_index(0);
+            return true;
+        }
+
+        if (!map_records(static_cast<size_t>(record_stat.st_size))) {
+            close();
+            return false;
+        }
+        if (header->magic == 0) {
+            // creation never finished
+            munmap(header, record_bytes);
+            header = nullptr;
+            if (!initialize_files()) {
+                close();
+                return false;
+            }
+            rebuild_index(0);
+            return true;
+        }
+        if (header->magic != magic || header->version != format_version ||
+            record_file_size(header->record_capacity) > record_bytes ||
+            static_cast<uint64_t>(heap_stat.st_size) < header->heap_capacity ||
+            !map_heap(header->heap_capacity)) {
+            close();
+            return false;
+        }
+
+        if (header->pending.op != OP_NONE) {
+            apply_pending();
+            recount_live();
+            retire();
+        }
+        rebuild_index(2 * header->live_count);
+        return true;
+    }
+
+    void close() {
+        if (heap != nullptr) {
+            munmap(heap, heap_bytes);
+        }
+        if (header != nullptr) {
+            munmap(header, record_bytes);
+        }
+        if (record_fd >= 0) {
+            ::close(record_fd);
+        }
+        if (heap_fd >= 0) {
+            ::close(heap_fd);
+        }
+        record_fd = -1;
+        heap_fd = -1;
+        header = nullptr;
+        records = nullptr;
+        heap = nullptr;
+        record_bytes = 0;
+        heap_bytes = 0;
+        name_index.clear();
+        index_used = 0;
+    }
+
+    bool is_open() const {
+        return header != nullptr;
+    }
+
+    // durable mode msyncs every add and sale through each redo log step, so
+    // a completed call survives power loss; it costs several syscalls per op
+    void set_durable(bool enabled) {
+        durable = enabled;
+    }
+
+    bool is_durable() const {
+        return durable;
+    }
+
+    // flushes both mappings to disk
+    bool sync() {
+        if (header == nullptr) {
+            return false;
+        }
+        return msync(header, record_bytes, MS_SYNC) == 0 &&
+               msync(heap, heap_bytes, MS_SYNC) == 0;
+    }
+
+    // returns the slot of the new item, or npos for an invalid line or a
+    // failure to grow the files
+    uint32_t add_item(const std::string &name, int quantity, float price) {
+        if (header == nullptr || quantity <= 0 || !(price >= 0) || name.size() > UINT32_MAX) {
+            return npos;
+        }
+
+        // a free slot whose heap space still fits the name is reused whole
+        uint32_t slot = header->free_head;
+        uint64_t name_offset;
+        uint32_t name_capacity;
+        const uint32_t name_length = static_cast<uint32_t>(name.size());
+        if (slot != npos && records[slot].name_capacity >= name_length) {
+            name_offset = records[slot].name_offset;
+            name_capacity = records[slot].name_capacity;
+        } else {
+            if (slot == npos) {
+                if (header->record_count == header->record_capacity && !grow_records()) {
+                    return npos;
+                }
+                slot = header->record_count;
+            }
+            if (!grow_heap(header->heap_size + name_length)) {
+                return npos;
+            }
+            name_offset = header->heap_size;
+            name_capacity = name_length;
+        }
+        // the name lands in space no live record points at, before the commit
+        std::memcpy(heap + name_offset, name.data(), name_length);
+        if (durable && name_length > 0) {
+            flush(heap + name_offset, name_length);
+        }
+
+        PendingOp &p = header->pending;
+        p.slot = slot;
+        p.quantity = quantity;
+        p.price = price;
+        p.name_offset = name_offset;
+        p.name_length = name_length;
+        p.name_capacity = name_capacity;
+        run_logged(OP_ADD);
+        index_insert(slot, hash_of(name.data(), name.size()));
+        return slot;
+    }
+
+    // the lowest live slot holding name, or npos
+    uint32_t find_item(const std::string &name) const {
+        if (header == nullptr) {
+            return npos;
+        }
+        const uint64_t name_hash = hash_of(name.data(), name.size());
+        const uint32_t tag = static_cast<uint32_t>(name_hash);
+        uint32_t found = npos;
+        for (size_t bucket = index_bucket(name_hash); name_index[bucket].slot != npos;
+             bucket = (bucket + 1) & (name_index.size() - 1)) {
+            const IndexEntry &entry = name_index[bucket];
+            const StoredItem &record = records[entry.slot];
+            if (entry.hash_tag == tag && entry.slot < found && record.name_length == name.size() &&
+                std::memcmp(heap + record.name_offset, name.data(), name.size()) == 0) {
+                found = entry.slot;
+            }
+        }
+        return found;
+    }
+
+    SaleStatus sell(const std::string &name, int quantity, float *money_earned = nullptr) {
+        uint32_t slot = find_item(name);
+        if (slot == npos) {
+            return SaleStatus::NOT_FOUND;
+        }
+        return sell_at(slot, quantity, money_earned);
+    }
+
+    SaleStatus sell_at(uint32_t slot, int sell_quantity, float *money_earned = nullptr) {
+        if (!is_live(slot)) {
+            return SaleStatus::NOT_FOUND;
+        }
+        if (sell_quantity <= 0) {
+            return SaleStatus::INVALID_QUANTITY;
+        }
+        const StoredItem &record = records[slot];
+        if (sell_quantity > record.quantity) {
+            return SaleStatus::INSUFFICIENT_QUANTITY;
+        }
+
+        // quantity and money move together through the log
+        float earned = record.price * sell_quantity;
+        PendingOp &p = header->pending;
+        p.slot = slot;
+        p.quantity = record.quantity - sell_quantity;
+        p.total_money = header->total_money + earned;
+        run_logged(OP_SELL);
+        if (p.quantity == 0) {
+            index_erase(slot, hash_of(get_name_data(slot), get_name_length(slot)));
+        }
+
+        if (money_earned != nullptr) {
+            *money_earned = earned;
+        }
+        return p.quantity == 0 ? SaleStatus::SOLD_OUT : SaleStatus::SOLD;
+    }
+
+    // in-place reads, valid until the next add grows the mapping
+
+    bool is_live(uint32_t slot) const {
+        return header != nullptr && slot < header->record_count && records[slot].state == SLOT_LIVE;
+    }
+
+    const char *get_name_data(uint32_t slot) const {
+        return heap + records[slot].name_offset;
+    }
+
+    size_t get_name_length(uint32_t slot) const {
+        return records[slot].name_length;
+    }
+
+    std::string get_name(uint32_t slot) const {
+        return std::string(get_name_data(slot), get_name_length(slot));
+    }
+
+    int get_quantity(uint32_t slot) const {
+        return records[slot].quantity;
+    }
+
+    float get_price(uint32_t slot) const {
+        return records[slot].price;
+    }
+
+    // slots to iterate with is_live; live and free slots are interleaved
+    uint32_t slot_count() const {
+        return header != nullptr ? header->record_count : 0;
+    }
+
+    size_t item_count() const {
+        return header != nullptr ? header->live_count : 0;
+    }
+
+    float get_total_money() const {
+        return header != nullptr ? header->total_money : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * subsystem an allocation is charged to
+ */
+enum class MemoryTag : std::uint8_t {
+    CROWD,              // crowd, sections and the contagion graph
+    EFFECTS,            // momentum effects, effect lists and the modifier table
+    ROSTERS,            // players and team / system rosters
+    INVENTORY_ITEMS,    // inventory item storage
+    NAMES               // heap-allocated ids and names
+};
+
+constexpr std::size_t kMemoryTagCount = 5;
+
+/**
+ * snapshot of one tag's counters
+ */
+struct MemoryTagStats {
+    std::size_t live_bytes;
+    std::size_t peak_bytes;
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+
+    std::uint64_t getLiveAllocations() const {
+        return allocations - deallocations;
+    }
+};
+
+/**
+ * process-wide allocation counters, one set per MemoryTag
+ *
+ * everything that should show up in the accounting allocates through
+ * TaggedAllocator (containers, TaggedName) or derives from MemoryTagged
+ * (objects owned through unique_ptr). counters are relaxed atomics: the
+ * numbers are for capacity planning, not for synchronisation.
+ */
+class MemoryAccounting {
+private:
+    struct Counters {
+        std::atomic<std::size_t> live_bytes{0};
+        std::atomic<std::size_t> peak_bytes{0};
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> deallocations{0};
+    };
+
+    static Counters& counters(MemoryTag tag) {
+        static Counters table[kMemoryTagCount];
+        return table[static_cast<std::size_t>(tag)];
+    }
+
+public:
+    static void recordAllocation(MemoryTag tag, std::size_t bytes) {
+        Counters& c = counters(tag);
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t live = c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::size_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void recordDeallocation(MemoryTag tag, std::size_t bytes) {
+        Counters& c = counters(tag);
+        c.deallocations.fetch_add(1, std::memory_order_relaxed);
+        c.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static MemoryTagStats getStats(MemoryTag tag) {
+        const Counters& c = counters(tag);
+        return {c.live_bytes.load(std::memory_order_relaxed), c.peak_bytes.load(std::memory_order_relaxed),
+                c.allocations.load(std::memory_order_relaxed), c.deallocations.load(std::memory_order_relaxed)};
+    }
+
+    // peaks restart from the current live bytes, e.g. between bench phases
+    static void resetPeaks() {
+        for (std::size_t tag = 0; tag < kMemoryTagCount; tag++) {
+            Counters& c = counters(static_cast<MemoryTag>(tag));
+            c.peak_bytes.store(c.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    static const char* getTagName(MemoryTag tag) {
+        static const char* const names[kMemoryTagCount] = {
+            "crowd", "effects", "rosters", "inventory_items", "names"
+        };
+        return names[static_cast<std::size_t>(tag)];
+    }
+
+    // one "memory.<tag> ..." line per tag, next to the other stats a tool prints
+    static void dump(std::FILE* out) {
+        for (std::size_t tag = 0; tag < kMemoryTagCount; tag++) {
+            const MemoryTag t = static_cast<MemoryTag>(tag);
+            const MemoryTagStats s = getStats(t);
+            std::fprintf(out, "memory.%-16s live %10zu  peak %10zu  allocations %10llu  live allocations %8llu\n",
+                         getTagName(t), s.live_bytes, s.peak_bytes,
+                         static_cast<unsigned long long>(s.allocations),
+                         static_cast<unsigned long long>(s.getLiveAllocations()));
+        }
+    }
+};
+
+/**
+ * std allocator that charges every allocation to Tag
+ */
+template <typename T, MemoryTag Tag>
+class TaggedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TaggedAllocator<U, Tag>;
+    };
+
+    TaggedAllocator() noexcept = default;
+
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {
+    }
+
+    T* allocate(std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        void* p;
+        if (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            p = ::operator new(bytes, std::align_val_t(alignof(T)));
+        } else {
+            p = ::operator new(bytes);
+        }
+        MemoryAccounting::recordAllocation(Tag, bytes);
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        MemoryAccounting::recordDeallocation(Tag, n * sizeof(T));
+        if (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const TaggedAllocator<U, Tag>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, MemoryTag Tag>
+using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+// names past the small-string buffer are charged to MemoryTag::NAMES
+using TaggedName = std::basic_string<char, std::char_traits<char>, TaggedAllocator<char, MemoryTag::NAMES>>;
+
+inline TaggedName makeTaggedName(const std::string& name) {
+    return TaggedName(name.data(), name.size());
+}
+
+inline std::string toString(const TaggedName& name) {
+    return std::string(name.data(), name.size());
+}
+
+/**
+ * base for heap objects charged to Tag when created with new / make_unique
+ *
+ * deletion must go through the most derived type (none of the tagged
+ * classes are polymorphic), so the sized delete sees the same size.
+ */
+template <MemoryTag Tag>
+struct MemoryTagged {
+    static void* operator new(std::size_t bytes) {
+        void* p = ::operator new(bytes);
+        MemoryAccounting::recordAllocation(Tag, bytes);
+        return p;
+    }
+
+    static void operator delete(void* p, std::size_t bytes) noexcept {
+        MemoryAccounting::recordDeallocation(Tag, bytes);
+        ::operator delete(p);
+    }
+};
+
+#endif
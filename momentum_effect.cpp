@@ -0,0 +1,52 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+namespace {
+
+// a strength is a fraction of the stat it modifies
+float clampMagnitude(float magnitude) {
+    return std::min(1.0f, std::max(0.0f, magnitude));
+}
+
+} // namespace
+
+MomentumEffect::MomentumEffect(EffectType type, float magnitude, float duration, Team* team)
+    : effect_type(type),
+      magnitude(clampMagnitude(magnitude)),
+      duration(duration),
+      remaining_time(duration),
+      target_team(team),
+      is_positive_effect(type == EffectType::REACTION_TIME_BOOST ||
+                         type == EffectType::ACCURACY_BOOST ||
+                         type == EffectType::BLOCKING_EFFICIENCY) {
+}
+
+void MomentumEffect::apply(Player& player) {
+    player.applyEffect(this);
+}
+
+void MomentumEffect::remove(Player& player) {
+    player.removeEffect(this);
+}
+
+void MomentumEffect::update(float delta_time) {
+    remaining_time = remaining_time > delta_time ? remaining_time - delta_time : 0.0f;
+}
+
+void MomentumEffect::refresh(float newMagnitude) {
+    magnitude = clampMagnitude(newMagnitude);
+    remaining_time = duration;
+}
+
+Team* MomentumEffect::getTargetTeam() const {
+    return target_team;
+}
+
+bool MomentumEffect::isPositiveEffect() const {
+    return is_positive_effect;
+}
+
+float MomentumEffect::getRemainingTime() const {
+    return remaining_time;
+}
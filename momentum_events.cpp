@@ -0,0 +1,85 @@
+#include "momentum_events.h"
+
+MomentumEventBus::MomentumEventBus() {
+}
+
+SubscriptionId MomentumEventBus::subscribe(MomentumCallback callback, void* context,
+                                           std::uint32_t topics) {
+    Subscriber subscriber{callback, context, topics & kAllMomentumTopics};
+    if (!free_ids.empty()) {
+        SubscriptionId id = free_ids.back();
+        free_ids.pop_back();
+        subscribers[id] = subscriber;
+        return id;
+    }
+    subscribers.push_back(subscriber);
+    return static_cast<SubscriptionId>(subscribers.size() - 1);
+}
+
+void MomentumEventBus::unsubscribe(SubscriptionId id) {
+    if (id < subscribers.size() && subscribers[id].callback != nullptr) {
+        // leave the hole so other ids stay valid; dispatch skips it
+        subscribers[id] = Subscriber{nullptr, nullptr, 0};
+        free_ids.push_back(id);
+    }
+}
+
+std::size_t MomentumEventBus::getSubscriberCount() const {
+    return subscribers.size() - free_ids.size();
+}
+
+void MomentumEventBus::publish(const MomentumNotification& notification) {
+    pending[static_cast<std::size_t>(notification.topic)].push_back(notification);
+}
+
+void MomentumEventBus::publishLevelChange(bool isHome, MomentumLevel previous, MomentumLevel next,
+                                          float momentum) {
+    publish({MomentumTopic::LEVEL_CHANGE, isHome, next > previous, previous, next, momentum});
+}
+
+void MomentumEventBus::publishThresholdCrossing(bool isHome, bool rising, float momentum) {
+    publish({MomentumTopic::THRESHOLD_CROSSING, isHome, rising,
+             MomentumLevel::NEUTRAL, MomentumLevel::NEUTRAL, momentum});
+}
+
+void MomentumEventBus::publishNoisePeak(float noiseLevel) {
+    publish({MomentumTopic::NOISE_PEAK, false, true,
+             MomentumLevel::NEUTRAL, MomentumLevel::NEUTRAL, noiseLevel});
+}
+
+void MomentumEventBus::dispatch() {
+    // swap the queues out first so callbacks can publish for the next tick
+    for (std::size_t topic = 0; topic < kMomentumTopicCount; topic++) {
+        dispatching[topic].clear();
+        dispatching[topic].swap(pending[topic]);
+    }
+
+    for (std::size_t topic = 0; topic < kMomentumTopicCount; topic++) {
+        const std::vector<MomentumNotification>& batch = dispatching[topic];
+        if (batch.empty()) {
+            continue;
+        }
+        const std::uint32_t mask = 1u << topic;
+        // index loop: a callback may subscribe or unsubscribe mid-dispatch
+        for (std::size_t i = 0; i < subscribers.size(); i++) {
+            const Subscriber subscriber = subscribers[i];
+            if ((subscriber.topic_mask & mask) != 0 && subscriber.callback != nullptr) {
+                subscriber.callback(subscriber.context, batch.data(), batch.size());
+            }
+        }
+    }
+}
+
+std::size_t MomentumEventBus::getPendingCount() const {
+    std::size_t count = 0;
+    for (const auto& queue : pending) {
+        count += queue.size();
+    }
+    return count;
+}
+
+void MomentumEventBus::clearPending() {
+    for (auto& queue : pending) {
+        queue.clear();
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef MOMENTUM_EVENTS_H
+#define MOMENTUM_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "momentum_types.h"
+
+enum class MomentumTopic : std::uint8_t {
+    LEVEL_CHANGE,
+    THRESHOLD_CROSSING,
+    NOISE_PEAK
+};
+
+constexpr std::size_t kMomentumTopicCount = 3;
+
+constexpr std::uint32_t topicMask(MomentumTopic topic) {
+    return 1u << static_cast<std::uint32_t>(topic);
+}
+
+constexpr std::uint32_t kAllMomentumTopics = (1u << kMomentumTopicCount) - 1;
+
+/**
+ * one notification; which fields are meaningful depends on the topic
+ *  LEVEL_CHANGE:       team, previous/new level, momentum
+ *  THRESHOLD_CROSSING: team, rising, momentum
+ *  NOISE_PEAK:         noise level
+ */
+struct MomentumNotification {
+    MomentumTopic topic;
+    bool is_home_team;
+    bool rising;
+    MomentumLevel previous_level;
+    MomentumLevel new_level;
+    float value;
+};
+
+using MomentumCallback = void (*)(void* context, const MomentumNotification* notifications,
+                                  std::size_t count);
+using SubscriptionId = std::uint32_t;
+
+/**
+ * batched publish/subscribe for momentum and crowd notifications
+ *
+ * publishers queue notifications during the tick; dispatch() then hands
+ * each subscriber one contiguous batch per subscribed topic. subscribers
+ * are plain function pointer + context pairs in a flat array, so there is
+ * no per-listener allocation and dispatch is a linear walk.
+ */
+class MomentumEventBus {
+private:
+    struct Subscriber {
+        MomentumCallback callback;
+        void* context;
+        std::uint32_t topic_mask;
+    };
+
+    std::vector<Subscriber> subscribers;
+    std::vector<SubscriptionId> free_ids;
+    std::vector<MomentumNotification> pending[kMomentumTopicCount];
+    std::vector<MomentumNotification> dispatching[kMomentumTopicCount];
+
+    template <typename T, void (T::*Method)(const MomentumNotification*, std::size_t)>
+    static void memberTrampoline(void* context, const MomentumNotification* notifications,
+                                 std::size_t count) {
+        (static_cast<T*>(context)->*Method)(notifications, count);
+    }
+
+public:
+    // constructor
+    MomentumEventBus();
+
+    // subscription
+    SubscriptionId subscribe(MomentumCallback callback, void* context,
+                             std::uint32_t topics = kAllMomentumTopics);
+    template <typename T, void (T::*Method)(const MomentumNotification*, std::size_t)>
+    SubscriptionId subscribe(T* listener, std::uint32_t topics = kAllMomentumTopics) {
+        return subscribe(&memberTrampoline<T, Method>, listener, topics);
+    }
+    void unsubscribe(SubscriptionId id);
+    std::size_t getSubscriberCount() const;
+
+    // publishing
+    void publish(const MomentumNotification& notification);
+    void publishLevelChange(bool isHome, MomentumLevel previous, MomentumLevel next, float momentum);
+    void publishThresholdCrossing(bool isHome, bool rising, float momentum);
+    void publishNoisePeak(float noiseLevel);
+
+    // delivery, once per tick
+    void dispatch();
+    std::size_t getPendingCount() const;
+    void clearPending();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "momentum_levels.h"
+
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+MomentumLevelClassifier::MomentumLevelClassifier(float minMomentum, float maxMomentum) {
+    setRange(minMomentum, maxMomentum);
+}
+
+void MomentumLevelClassifier::setRange(float minMomentum, float maxMomentum) {
+    // five equal bands across the meter
+    const float band = (maxMomentum - minMomentum) / 5.0f;
+    for (int i = 0; i < 4; i++) {
+        boundaries[i] = minMomentum + band * static_cast<float>(i + 1);
+    }
+}
+
+MomentumLevel MomentumLevelClassifier::classify(float momentum) const {
+    const int level = (momentum >= boundaries[0]) + (momentum >= boundaries[1])
+                    + (momentum >= boundaries[2]) + (momentum >= boundaries[3]);
+    return static_cast<MomentumLevel>(level);
+}
+
+void MomentumLevelClassifier::classifyPair(float home, float away,
+                                           MomentumLevel& homeLevel, MomentumLevel& awayLevel) const {
+#if defined(__SSE2__)
+    // one compare per team against all four boundaries, counted from the mask
+    const __m128 bounds = _mm_load_ps(boundaries);
+    const int home_mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_set1_ps(home), bounds));
+    const int away_mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_set1_ps(away), bounds));
+    // masks are always a run of low bits since the boundaries ascend
+    static const unsigned char kRunLength[16] = {0, 1, 0, 2, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 4};
+    homeLevel = static_cast<MomentumLevel>(kRunLength[home_mask]);
+    awayLevel = static_cast<MomentumLevel>(kRunLength[away_mask]);
+#else
+    homeLevel = classify(home);
+    awayLevel = classify(away);
+#endif
+}
+
+void MomentumLevelClassifier::classify(const float* momentum, std::size_t count,
+                                       MomentumLevel* levels) const {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 b0 = _mm_set1_ps(boundaries[0]);
+    const __m128 b1 = _mm_set1_ps(boundaries[1]);
+    const __m128 b2 = _mm_set1_ps(boundaries[2]);
+    const __m128 b3 = _mm_set1_ps(boundaries[3]);
+    alignas(16) int counted[4];
+    for (; i + 4 <= count; i += 4) {
+        const __m128 m = _mm_loadu_ps(momentum + i);
+        // each passed compare is -1, so the negated sum is the level
+        __m128i sum = _mm_castps_si128(_mm_cmpge_ps(m, b0));
+        sum = _mm_add_epi32(sum, _mm_castps_si128(_mm_cmpge_ps(m, b1)));
+        sum = _mm_add_epi32(sum, _mm_castps_si128(_mm_cmpge_ps(m, b2)));
+        sum = _mm_add_epi32(sum, _mm_castps_si128(_mm_cmpge_ps(m, b3)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(counted), _mm_sub_epi32(_mm_setzero_si128(), sum));
+        levels[i] = static_cast<MomentumLevel>(counted[0]);
+        levels[i + 1] = static_cast<MomentumLevel>(counted[1]);
+        levels[i + 2] = static_cast<MomentumLevel>(counted[2]);
+        levels[i + 3] = static_cast<MomentumLevel>(counted[3]);
+    }
+#endif
+    for (; i < count; i++) {
+        levels[i] = classify(momentum[i]);
+    }
+}
+
+float MomentumLevelClassifier::getLowerBound(MomentumLevel level) const {
+    const int index = static_cast<int>(level);
+    return index == 0 ? -std::numeric_limits<float>::infinity() : boundaries[index - 1];
+}
+
+float MomentumLevelClassifier::getUpperBound(MomentumLevel level) const {
+    const int index = static_cast<int>(level);
+    return index == 4 ? std::numeric_limits<float>::infinity() : boundaries[index];
+}
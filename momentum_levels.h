@@ -0,0 +1,47 @@
+#ifndef MOMENTUM_LEVELS_H
+#define MOMENTUM_LEVELS_H
+
+#include <cstddef>
+
+#include "momentum_types.h"
+
+/**
+ * a team's momentum moved into a different MomentumLevel band
+ */
+struct MomentumLevelChange {
+    bool is_home_team;
+    MomentumLevel previous_level;
+    MomentumLevel new_level;
+    float momentum;
+};
+
+/**
+ * maps momentum values to MomentumLevel through a precomputed table of
+ * four band boundaries
+ *
+ * a level is the number of boundaries at or below the value, so the
+ * lookup is a compare-and-count with no branches. the bulk overload
+ * classifies four values per SSE compare, for both teams of many games.
+ */
+class MomentumLevelClassifier {
+private:
+    alignas(16) float boundaries[4];
+
+public:
+    // constructor
+    MomentumLevelClassifier(float minMomentum = 0.0f, float maxMomentum = 100.0f);
+
+    // classification
+    MomentumLevel classify(float momentum) const;
+    void classifyPair(float home, float away, MomentumLevel& homeLevel, MomentumLevel& awayLevel) const;
+    void classify(const float* momentum, std::size_t count, MomentumLevel* levels) const;
+
+    // band edges, for callers that cache a level until it is left
+    float getLowerBound(MomentumLevel level) const;
+    float getUpperBound(MomentumLevel level) const;
+
+    // configuration
+    void setRange(float minMomentum, float maxMomentum);
+};
+
+#endif
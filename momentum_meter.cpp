@@ -0,0 +1,136 @@
+#include "crowd_momentum_system.h"
+
+#include "momentum_model.h"
+
+MomentumMeter::MomentumMeter(float threshold, float decayRate)
+    : home_momentum(50.0f),
+      away_momentum(50.0f),
+      momentum_threshold(threshold),
+      momentum_decay_rate(decayRate),
+      max_momentum(100.0f),
+      min_momentum(0.0f),
+      level_classifier(0.0f, 100.0f),
+      home_level(MomentumLevel::NEUTRAL),
+      away_level(MomentumLevel::NEUTRAL),
+      home_band_low(0.0f),
+      home_band_high(0.0f),
+      away_band_low(0.0f),
+      away_band_high(0.0f),
+      home_above_threshold(false),
+      away_above_threshold(false),
+      event_bus(nullptr) {
+    resetMomentum();
+}
+
+void MomentumMeter::setMomentum(const Team& team, float value) {
+    const bool is_home = team.isHomeTeam();
+    const float clamped = clampMomentum(value, min_momentum, max_momentum);
+    (is_home ? home_momentum : away_momentum) = clamped;
+    refreshLevel(is_home, clamped);
+}
+
+void MomentumMeter::adjustMomentum(const Team& team, float adjustment) {
+    setMomentum(team, getMomentum(team) + adjustment);
+}
+
+void MomentumMeter::decayMomentum(float delta_time) {
+    // a negative step would push momentum away from neutral and off the meter
+    if (!(delta_time > 0.0f)) {
+        return;
+    }
+    const float neutral = 0.5f * (min_momentum + max_momentum);
+    const float factor = momentumDecayFactor(momentum_decay_rate, delta_time);
+    home_momentum = decayTowardNeutral(home_momentum, neutral, factor);
+    away_momentum = decayTowardNeutral(away_momentum, neutral, factor);
+    refreshLevel(true, home_momentum);
+    refreshLevel(false, away_momentum);
+}
+
+void MomentumMeter::resetMomentum() {
+    home_momentum = 0.5f * (min_momentum + max_momentum);
+    away_momentum = home_momentum;
+
+    // seed the caches directly; a reset is not a crossing
+    level_classifier.classifyPair(home_momentum, away_momentum, home_level, away_level);
+    home_band_low = level_classifier.getLowerBound(home_level);
+    home_band_high = level_classifier.getUpperBound(home_level);
+    away_band_low = level_classifier.getLowerBound(away_level);
+    away_band_high = level_classifier.getUpperBound(away_level);
+    home_above_threshold = home_momentum >= momentum_threshold;
+    away_above_threshold = away_momentum >= momentum_threshold;
+    level_changes.clear();
+}
+
+void MomentumMeter::refreshLevel(bool isHome, float momentum) {
+    float& band_low = isHome ? home_band_low : away_band_low;
+    float& band_high = isHome ? home_band_high : away_band_high;
+    if (momentum < band_low || momentum >= band_high) {
+        MomentumLevel& level = isHome ? home_level : away_level;
+        const MomentumLevel previous = level;
+        level = level_classifier.classify(momentum);
+        band_low = level_classifier.getLowerBound(level);
+        band_high = level_classifier.getUpperBound(level);
+
+        level_changes.push_back({isHome, previous, level, momentum});
+        if (event_bus != nullptr) {
+            event_bus->publishLevelChange(isHome, previous, level, momentum);
+        }
+    }
+
+    bool& above = isHome ? home_above_threshold : away_above_threshold;
+    const bool now_above = momentum >= momentum_threshold;
+    if (now_above != above) {
+        above = now_above;
+        if (event_bus != nullptr) {
+            event_bus->publishThresholdCrossing(isHome, now_above, momentum);
+        }
+    }
+}
+
+const MomentumLevelClassifier& MomentumMeter::getLevelClassifier() const {
+    return level_classifier;
+}
+
+const std::vector<MomentumLevelChange>& MomentumMeter::getLevelChanges() const {
+    return level_changes;
+}
+
+void MomentumMeter::clearLevelChanges() {
+    level_changes.clear();
+}
+
+void MomentumMeter::setThreshold(float threshold) {
+    momentum_threshold = threshold;
+    home_above_threshold = home_momentum >= momentum_threshold;
+    away_above_threshold = away_momentum >= momentum_threshold;
+}
+
+void MomentumMeter::setDecayRate(float rate) {
+    momentum_decay_rate = rate > 0.0f ? rate : 0.0f;
+}
+
+float MomentumMeter::getThreshold() const {
+    return momentum_threshold;
+}
+
+float MomentumMeter::getDecayRate() const {
+    return momentum_decay_rate;
+}
+
+void MomentumMeter::setMomentumRange(float minMomentum, float maxMomentum) {
+    if (maxMomentum <= minMomentum) {
+        return;
+    }
+    min_momentum = minMomentum;
+    max_momentum = maxMomentum;
+    level_classifier.setRange(minMomentum, maxMomentum);
+    resetMomentum();
+}
+
+void MomentumMeter::setEventBus(MomentumEventBus* bus) {
+    event_bus = bus;
+}
+
+MomentumEventBus* MomentumMeter::getEventBus() const {
+    return event_bus;
+}
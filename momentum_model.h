@@ -0,0 +1,37 @@
+#ifndef MOMENTUM_MODEL_H
+#define MOMENTUM_MODEL_H
+
+#include <cmath>
+
+/**
+ * tunable parameters of the momentum model
+ * MomentumMeter and the what-if engine both step momentum with these
+ */
+struct MomentumParams {
+    float decay_rate = 0.1f;
+    float impact_scale = 1.0f;
+    float min_momentum = 0.0f;
+    float max_momentum = 100.0f;
+
+    float getNeutralMomentum() const {
+        return 0.5f * (min_momentum + max_momentum);
+    }
+};
+
+// momentum relaxes exponentially towards neutral, so over a fixed step the
+// whole decay is one multiply by this factor
+inline float momentumDecayFactor(float decay_rate, float delta_time) {
+    return std::exp(-decay_rate * delta_time);
+}
+
+inline float decayTowardNeutral(float momentum, float neutral, float factor) {
+    return neutral + (momentum - neutral) * factor;
+}
+
+inline float clampMomentum(float momentum, float min_momentum, float max_momentum) {
+    return momentum < min_momentum ? min_momentum
+         : momentum > max_momentum ? max_momentum
+         : momentum;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "momentum_modifiers.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+MomentumModifierTable::MomentumModifierTable() {
+}
+
+std::uint32_t MomentumModifierTable::allocateSlot() {
+    if (!free_slots.empty()) {
+        std::uint32_t slot = free_slots.back();
+        free_slots.pop_back();
+        clearRow(slot);
+        return slot;
+    }
+    rows.push_back(ModifierRow{});
+    return static_cast<std::uint32_t>(rows.size() - 1);
+}
+
+void MomentumModifierTable::releaseSlot(std::uint32_t slot) {
+    if (slot < rows.size()) {
+        // rows stay in place so queries built earlier never read out of range
+        clearRow(slot);
+        free_slots.push_back(slot);
+    }
+}
+
+std::size_t MomentumModifierTable::getSlotCount() const {
+    return rows.size();
+}
+
+void MomentumModifierTable::clearModifiers() {
+    std::fill(rows.begin(), rows.end(), ModifierRow{});
+}
+
+void MomentumModifierTable::clearRow(std::uint32_t slot) {
+    rows[slot] = ModifierRow{};
+}
+
+void MomentumModifierTable::addModifier(std::uint32_t slot, EffectType effect, float amount) {
+    rows[slot].values[static_cast<std::size_t>(effect)] += amount;
+}
+
+void MomentumModifierTable::setModifier(std::uint32_t slot, EffectType effect, float value) {
+    rows[slot].values[static_cast<std::size_t>(effect)] = value;
+}
+
+void MomentumModifierTable::setRow(std::uint32_t slot, const float* values) {
+    std::copy(values, values + kModifierStride, rows[slot].values);
+}
+
+ModifierQuery MomentumModifierTable::makeQuery(std::uint32_t slot, EffectType effect) {
+    if (slot == kNoModifierSlot) {
+        return kNoModifierQuery;
+    }
+    return slot * static_cast<std::uint32_t>(kModifierStride) + static_cast<std::uint32_t>(effect);
+}
+
+float MomentumModifierTable::getModifier(std::uint32_t slot, EffectType effect) const {
+    return slot < rows.size() ? rows[slot].values[static_cast<std::size_t>(effect)] : 0.0f;
+}
+
+void MomentumModifierTable::gather(const ModifierQuery* queries, std::size_t count,
+                                   float* modifiers) const {
+    // queries are flat offsets into the table, so this is a pure gather;
+    // kNoModifierQuery lanes are masked off and read as 0
+    const float* table = rows.empty() ? nullptr : rows.front().values;
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i none = _mm256_set1_epi32(static_cast<int>(kNoModifierQuery));
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(queries + i));
+        __m256 valid = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(index, none), _mm256_set1_epi32(-1)));
+        _mm256_storeu_ps(modifiers + i, _mm256_mask_i32gather_ps(_mm256_setzero_ps(), table, index, valid, 4));
+    }
+#endif
+    for (; i < count; i++) {
+        modifiers[i] = queries[i] != kNoModifierQuery ? table[queries[i]] : 0.0f;
+    }
+}
+
+void MomentumModifierTable::gather(const std::vector<ModifierQuery>& queries,
+                                   std::vector<float>& modifiers) const {
+    modifiers.resize(queries.size());
+    gather(queries.data(), queries.size(), modifiers.data());
+}
@@ -0,0 +1,69 @@
+#ifndef MOMENTUM_MODIFIERS_H
+#define MOMENTUM_MODIFIERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory_accounting.h"
+#include "momentum_types.h"
+
+// one row per player, padded to 8 floats so a row is exactly 32 bytes
+constexpr std::size_t kModifierStride = 8;
+
+// slot of a player that is not registered with any table
+constexpr std::uint32_t kNoModifierSlot = 0xffffffffu;
+
+/**
+ * a precomputed modifier lookup: row offset of the player plus the effect
+ * build once per roster change with MomentumModifierTable::makeQuery
+ */
+using ModifierQuery = std::uint32_t;
+
+// query for a player without a slot; it always gathers 0. real queries
+// stay below 2^31, since the AVX2 gather reads its indices as signed
+constexpr ModifierQuery kNoModifierQuery = 0xffffffffu;
+
+/**
+ * per-player momentum modifiers, refreshed once per tick
+ *
+ * each registered player's row holds one signed modifier per effect type:
+ * the capped effect total scaled by the player's sensitivity curve, with
+ * penalties negative, exactly as the player's stats were last computed
+ * from. gameplay code answers all momentum questions for an upcoming play
+ * with one gather over this table instead of walking each player's
+ * effect list.
+ */
+class MomentumModifierTable {
+private:
+    struct alignas(32) ModifierRow {
+        float values[kModifierStride];
+    };
+
+    TaggedVector<ModifierRow, MemoryTag::EFFECTS> rows;
+    TaggedVector<std::uint32_t, MemoryTag::EFFECTS> free_slots;
+
+public:
+    // constructor
+    MomentumModifierTable();
+
+    // slot management
+    std::uint32_t allocateSlot();
+    void releaseSlot(std::uint32_t slot);
+    std::size_t getSlotCount() const;
+
+    // refresh
+    void clearModifiers();
+    void clearRow(std::uint32_t slot);
+    void addModifier(std::uint32_t slot, EffectType effect, float amount);
+    void setModifier(std::uint32_t slot, EffectType effect, float value);
+    void setRow(std::uint32_t slot, const float* values);  // kModifierStride values
+
+    // queries; kNoModifierSlot gives kNoModifierQuery
+    static ModifierQuery makeQuery(std::uint32_t slot, EffectType effect);
+    float getModifier(std::uint32_t slot, EffectType effect) const;
+    void gather(const ModifierQuery* queries, std::size_t count, float* modifiers) const;
+    void gather(const std::vector<ModifierQuery>& queries, std::vector<float>& modifiers) const;
+};
+
+#endif
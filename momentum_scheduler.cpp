@@ -0,0 +1,86 @@
+#include "momentum_scheduler.h"
+
+TickScheduler::TickScheduler(float smoothing)
+    : stage_cost{},
+      smoothing(smoothing),
+      has_deadline(false),
+      deadline(),
+      level(TickDegradation::FULL),
+      ticks_at_level{} {
+}
+
+void TickScheduler::setDeadline(Clock::time_point tickDeadline) {
+    deadline = tickDeadline;
+    has_deadline = true;
+}
+
+void TickScheduler::clearDeadline() {
+    has_deadline = false;
+    level = TickDegradation::FULL;
+}
+
+void TickScheduler::dropExpiredDeadline() {
+    if (has_deadline && Clock::now() >= deadline) {
+        clearDeadline();
+    }
+}
+
+bool TickScheduler::hasDeadline() const {
+    return has_deadline;
+}
+
+TickDegradation TickScheduler::planTick(std::size_t ticksRemaining) {
+    if (!has_deadline) {
+        level = TickDegradation::FULL;
+    } else {
+        const float remaining = std::chrono::duration<float>(deadline - Clock::now()).count();
+        const float budget = remaining / static_cast<float>(ticksRemaining > 0 ? ticksRemaining : 1);
+
+        // predicted cost of a tick at each level; a LOD contagion pass costs
+        // the same as a full one but only runs every kCrowdLodStride ticks
+        const float critical = stage_cost[static_cast<std::size_t>(TickStage::CRITICAL)];
+        const float crowd = stage_cost[static_cast<std::size_t>(TickStage::CROWD)];
+        const float noise = stage_cost[static_cast<std::size_t>(TickStage::NOISE)];
+        const float history = stage_cost[static_cast<std::size_t>(TickStage::HISTORY)];
+        const float crowd_lod = crowd / static_cast<float>(kCrowdLodStride);
+
+        if (critical + crowd + noise + history <= budget) {
+            level = TickDegradation::FULL;
+        } else if (critical + crowd_lod + noise + history <= budget) {
+            level = TickDegradation::CROWD_LOD;
+        } else if (critical + crowd_lod + history <= budget) {
+            level = TickDegradation::NO_NOISE;
+        } else if (critical + crowd_lod <= budget) {
+            level = TickDegradation::NO_HISTORY;
+        } else {
+            // not even room for critical work and a share of contagion
+            level = TickDegradation::CRITICAL_ONLY;
+        }
+    }
+    ticks_at_level[static_cast<std::size_t>(level)]++;
+    return level;
+}
+
+void TickScheduler::recordCost(TickStage stage, float seconds) {
+    float& cost = stage_cost[static_cast<std::size_t>(stage)];
+    // the first sample seeds the estimate instead of creeping up from zero
+    cost = cost == 0.0f ? seconds : cost + smoothing * (seconds - cost);
+}
+
+TickDegradation TickScheduler::getLevel() const {
+    return level;
+}
+
+float TickScheduler::getStageCost(TickStage stage) const {
+    return stage_cost[static_cast<std::size_t>(stage)];
+}
+
+std::uint64_t TickScheduler::getTickCount(TickDegradation degradation) const {
+    return ticks_at_level[static_cast<std::size_t>(degradation)];
+}
+
+void TickScheduler::resetCounts() {
+    for (std::uint64_t& count : ticks_at_level) {
+        count = 0;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef MOMENTUM_SCHEDULER_H
+#define MOMENTUM_SCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * the parts of a CrowdMomentumSystem tick, as costed by TickScheduler
+ */
+enum class TickStage {
+    CRITICAL,   // momentum decay, effects, cooldowns, modifier table; runs first
+    CROWD,      // one full enthusiasm contagion pass over every section
+    NOISE,      // crowd noise propagation
+    HISTORY     // momentum history sampling
+};
+
+constexpr std::size_t kTickStageCount = 4;
+
+/**
+ * optional work shed under deadline pressure; each level keeps the cuts of
+ * the ones before it. gameplay-critical work is never shed.
+ */
+enum class TickDegradation {
+    FULL,           // everything every tick
+    CROWD_LOD,      // contagion only every kCrowdLodStride ticks, with the summed step
+    NO_NOISE,       // ... and crowd noise held at its last value
+    NO_HISTORY,     // ... and no momentum history samples
+    CRITICAL_ONLY   // ... and no contagion; its step carries over to the next pass
+};
+
+constexpr std::size_t kTickDegradationCount = 5;
+
+// ticks between contagion passes at TickDegradation::CROWD_LOD and below
+constexpr int kCrowdLodStride = 4;
+
+/**
+ * deadline-aware planning of fixed-step ticks
+ *
+ * the scheduler keeps a smoothed cost per TickStage, measured as the stages
+ * run. before each tick, planTick splits the time left until the deadline
+ * over the ticks still due and picks the least degraded level whose
+ * predicted cost fits. without a deadline nothing is measured and every
+ * tick runs in full.
+ */
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    float stage_cost[kTickStageCount];  // seconds per run, smoothed
+    float smoothing;
+    bool has_deadline;
+    Clock::time_point deadline;
+    TickDegradation level;
+    std::uint64_t ticks_at_level[kTickDegradationCount];
+
+public:
+    // constructor
+    explicit TickScheduler(float smoothing = 0.1f);
+
+    // deadline for the ticks of the next update. the system drops it after
+    // the update in which it passes, so callers set one every frame
+    void setDeadline(Clock::time_point tickDeadline);
+    void clearDeadline();
+    void dropExpiredDeadline();
+    bool hasDeadline() const;
+
+    // planning and measurement
+    TickDegradation planTick(std::size_t ticksRemaining);
+    void recordCost(TickStage stage, float seconds);
+
+    // queries
+    TickDegradation getLevel() const;
+    float getStageCost(TickStage stage) const;
+    std::uint64_t getTickCount(TickDegradation level) const;
+    void resetCounts();
+};
+
+#endif
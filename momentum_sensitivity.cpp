@@ -0,0 +1,50 @@
+#include "momentum_sensitivity.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+// per-position weights, in EffectType order: reaction, accuracy, blocking,
+// snap timing, focus, false start
+constexpr float kPositionWeights[][kEffectTypeCount] = {
+    {1.0f, 1.3f, 0.4f, 1.3f, 1.3f, 0.8f},   // QUARTERBACK
+    {1.3f, 0.6f, 0.8f, 1.0f, 0.8f, 0.8f},   // RUNNING_BACK
+    {1.3f, 1.2f, 0.4f, 1.0f, 1.2f, 1.0f},   // WIDE_RECEIVER
+    {1.1f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},   // TIGHT_END
+    {0.7f, 0.3f, 1.4f, 1.2f, 0.6f, 1.4f},   // OFFENSIVE_LINE
+    {1.0f, 0.3f, 1.4f, 1.0f, 0.6f, 1.3f},   // DEFENSIVE_LINE
+    {1.2f, 0.6f, 1.1f, 1.0f, 0.9f, 1.0f},   // LINEBACKER
+    {1.3f, 1.0f, 0.5f, 1.0f, 1.1f, 0.9f},   // CORNERBACK
+    {1.2f, 0.9f, 0.7f, 1.0f, 1.0f, 0.9f},   // SAFETY
+    {0.3f, 1.4f, 0.0f, 1.2f, 1.5f, 0.3f}    // KICKER
+};
+
+bool isPenalty(std::size_t type) {
+    return type == static_cast<std::size_t>(EffectType::SNAP_TIMING_PENALTY) ||
+           type == static_cast<std::size_t>(EffectType::FOCUS_REDUCTION) ||
+           type == static_cast<std::size_t>(EffectType::FALSE_START_INCREASE);
+}
+
+} // namespace
+
+MomentumSensitivity computeMomentumSensitivity(Position position, float composure, float experience,
+                                               bool immune) {
+    MomentumSensitivity sensitivity{};
+    if (immune) {
+        return sensitivity;
+    }
+
+    // 1.25 for a rookie down to 0.75 for a ten-season veteran
+    const float seasons = std::min(10.0f, std::max(0.0f, experience));
+    const float experience_scale = 1.0f + 0.05f * (kNeutralExperience - seasons);
+    const float resistance = 1.0f - std::min(1.0f, std::max(0.0f, composure));
+
+    const float* weights = kPositionWeights[static_cast<std::size_t>(position)];
+    for (std::size_t type = 0; type < kEffectTypeCount; type++) {
+        sensitivity.coefficients[type] = isPenalty(type)
+            ? std::min(1.0f, weights[type] * experience_scale * resistance)
+            : weights[type];
+    }
+    return sensitivity;
+}
@@ -0,0 +1,34 @@
+#ifndef MOMENTUM_SENSITIVITY_H
+#define MOMENTUM_SENSITIVITY_H
+
+#include "momentum_modifiers.h"
+#include "momentum_types.h"
+
+/**
+ * how strongly one player feels each effect type
+ *
+ * one coefficient per EffectType, padded to a modifier table row, so a
+ * player's modifiers are the effect totals times these coefficients,
+ * lane by lane. immune players have all-zero coefficients rather than a
+ * flag that every evaluation has to test.
+ */
+struct MomentumSensitivity {
+    float coefficients[kModifierStride];
+};
+
+/**
+ * sensitivity curve of a player from position, composure and experience
+ *
+ * position picks which effects matter (a kicker shrugs off blocking, a
+ * lineman is prone to false starts); composure scales penalties down as
+ * before; experience dampens penalties for veterans and amplifies them for
+ * rookies, neutral at kNeutralExperience seasons. penalty coefficients are
+ * capped at 1 so a full-strength penalty cannot take a stat below zero.
+ */
+MomentumSensitivity computeMomentumSensitivity(Position position, float composure, float experience,
+                                               bool immune);
+
+// seasons at which experience neither dampens nor amplifies penalties
+constexpr float kNeutralExperience = 5.0f;
+
+#endif
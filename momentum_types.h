@@ -0,0 +1,76 @@
+#ifndef MOMENTUM_TYPES_H
+#define MOMENTUM_TYPES_H
+
+#include <cstddef>
+
+// enume...
+enum class EventType {
+    TOUCHDOWN,
+    INTERCEPTION,
+    SACK,
+    FOURTH_DOWN_STOP,
+    FUMBLE,
+    FIELD_GOAL,
+    PENALTY,
+    SAFETY,
+    TURNOVER
+};
+
+enum class EffectType {
+    REACTION_TIME_BOOST,
+    ACCURACY_BOOST,
+    BLOCKING_EFFICIENCY,
+    SNAP_TIMING_PENALTY,
+    FOCUS_REDUCTION,
+    FALSE_START_INCREASE
+};
+
+enum class MomentumLevel {
+    VERY_LOW,
+    LOW,
+    NEUTRAL,
+    HIGH,
+    VERY_HIGH
+};
+
+enum class VenueType {
+    SMALL_STADIUM,
+    MEDIUM_STADIUM,
+    LARGE_STADIUM,
+    DOME_STADIUM,
+    OUTDOOR_STADIUM
+};
+
+enum class Position {
+    QUARTERBACK,
+    RUNNING_BACK,
+    WIDE_RECEIVER,
+    TIGHT_END,
+    OFFENSIVE_LINE,
+    DEFENSIVE_LINE,
+    LINEBACKER,
+    CORNERBACK,
+    SAFETY,
+    KICKER
+};
+
+// utility structures
+struct PlayerStats {
+    float speed;
+    float accuracy;
+    float strength;
+    float awareness;
+    float composure;
+};
+
+// one momentum history sample, taken by the system every history interval
+struct MomentumSample {
+    float time;
+    float home_momentum;
+    float away_momentum;
+};
+
+// number of EffectType values, for tables indexed by effect
+constexpr std::size_t kEffectTypeCount = 6;
+
+#endif
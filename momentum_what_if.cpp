@@ -0,0 +1,196 @@
+#include "momentum_what_if.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// variants stepped together in one pass over the event stream; a multiple
+// of the widest vector width we build for
+constexpr std::size_t kBatchLanes = 64;
+
+} // namespace
+
+GameRecording::GameRecording(float initialHome, float initialAway)
+    : initial_home_momentum(initialHome),
+      initial_away_momentum(initialAway),
+      duration(0.0) {
+}
+
+void GameRecording::recordEvent(double timestamp, float impact, bool isHomeTeamEvent) {
+    // events arrive in game order; keep the stream sorted if one is late
+    RecordedEvent event{timestamp, impact, isHomeTeamEvent};
+    if (events.empty() || events.back().timestamp <= timestamp) {
+        events.push_back(event);
+    } else {
+        auto pos = std::upper_bound(events.begin(), events.end(), timestamp,
+                                    [](double t, const RecordedEvent& e) { return t < e.timestamp; });
+        events.insert(pos, event);
+    }
+    duration = std::max(duration, timestamp);
+}
+
+void GameRecording::setDuration(double newDuration) {
+    duration = newDuration;
+}
+
+void GameRecording::clear() {
+    events.clear();
+    duration = 0.0;
+}
+
+float GameRecording::getInitialHomeMomentum() const {
+    return initial_home_momentum;
+}
+
+float GameRecording::getInitialAwayMomentum() const {
+    return initial_away_momentum;
+}
+
+double GameRecording::getDuration() const {
+    return duration;
+}
+
+const std::vector<RecordedEvent>& GameRecording::getEvents() const {
+    return events;
+}
+
+MomentumWhatIfEngine::MomentumWhatIfEngine(float tickInterval)
+    : tick_interval(tickInterval > 0.0f ? tickInterval : 1.0f),
+      worker_count(0) {
+}
+
+std::size_t MomentumWhatIfEngine::getEventTick(double timestamp) const {
+    // tick n covers [(n - 1) * interval, n * interval)
+    return timestamp > 0.0 ? static_cast<std::size_t>(timestamp / tick_interval) + 1 : 1;
+}
+
+std::size_t MomentumWhatIfEngine::getSampleCount(const GameRecording& recording) const {
+    // a duration ending mid-tick gets the whole tick, and events past the
+    // duration extend the curve rather than being dropped
+    const double duration = std::max(0.0, recording.getDuration());
+    std::size_t ticks = static_cast<std::size_t>(std::ceil(duration / tick_interval));
+    const std::vector<RecordedEvent>& events = recording.getEvents();
+    if (!events.empty()) {
+        ticks = std::max(ticks, getEventTick(events.back().timestamp));
+    }
+    return ticks + 1;
+}
+
+MomentumCurve MomentumWhatIfEngine::run(const GameRecording& recording,
+                                        const MomentumParams& params) const {
+    MomentumCurve curve;
+    runBatch(recording, &params, 1, &curve);
+    return curve;
+}
+
+std::vector<MomentumCurve> MomentumWhatIfEngine::runVariants(
+        const GameRecording& recording, const std::vector<MomentumParams>& variants) const {
+    std::vector<MomentumCurve> curves(variants.size());
+    const std::size_t batches = (variants.size() + kBatchLanes - 1) / kBatchLanes;
+    if (batches == 0) {
+        return curves;
+    }
+
+    unsigned workers = worker_count != 0 ? worker_count : std::thread::hardware_concurrency();
+    workers = std::max(1u, std::min<unsigned>(workers, static_cast<unsigned>(batches)));
+
+    auto runBatches = [&](std::size_t first) {
+        for (std::size_t b = first; b < batches; b += workers) {
+            const std::size_t begin = b * kBatchLanes;
+            const std::size_t count = std::min(kBatchLanes, variants.size() - begin);
+            runBatch(recording, variants.data() + begin, count, curves.data() + begin);
+        }
+    };
+
+    if (workers == 1) {
+        runBatches(0);
+        return curves;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; w++) {
+        threads.emplace_back(runBatches, w);
+    }
+    runBatches(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return curves;
+}
+
+void MomentumWhatIfEngine::runBatch(const GameRecording& recording, const MomentumParams* variants,
+                                    std::size_t count, MomentumCurve* curves) const {
+    // structure of arrays, one lane per variant, so every inner loop below
+    // is a straight-line loop the compiler turns into packed float ops
+    alignas(32) float home[kBatchLanes];
+    alignas(32) float away[kBatchLanes];
+    alignas(32) float factor[kBatchLanes];
+    alignas(32) float neutral[kBatchLanes];
+    alignas(32) float scale[kBatchLanes];
+    alignas(32) float lo[kBatchLanes];
+    alignas(32) float hi[kBatchLanes];
+
+    for (std::size_t v = 0; v < count; v++) {
+        const MomentumParams& p = variants[v];
+        lo[v] = p.min_momentum;
+        hi[v] = p.max_momentum;
+        neutral[v] = p.getNeutralMomentum();
+        scale[v] = p.impact_scale;
+        factor[v] = momentumDecayFactor(p.decay_rate, tick_interval);
+        home[v] = clampMomentum(recording.getInitialHomeMomentum(), lo[v], hi[v]);
+        away[v] = clampMomentum(recording.getInitialAwayMomentum(), lo[v], hi[v]);
+    }
+
+    const std::size_t samples = getSampleCount(recording);
+    for (std::size_t v = 0; v < count; v++) {
+        curves[v].home_momentum.resize(samples);
+        curves[v].away_momentum.resize(samples);
+        curves[v].home_momentum[0] = home[v];
+        curves[v].away_momentum[0] = away[v];
+    }
+
+    const std::vector<RecordedEvent>& events = recording.getEvents();
+    std::size_t next_event = 0;
+
+    for (std::size_t tick = 1; tick < samples; tick++) {
+        for (; next_event < events.size() && getEventTick(events[next_event].timestamp) <= tick; next_event++) {
+            const RecordedEvent& event = events[next_event];
+            float* momentum = event.is_home_team_event ? home : away;
+            const float impact = event.momentum_impact;
+            for (std::size_t v = 0; v < count; v++) {
+                momentum[v] = clampMomentum(momentum[v] + impact * scale[v], lo[v], hi[v]);
+            }
+        }
+
+        for (std::size_t v = 0; v < count; v++) {
+            home[v] = decayTowardNeutral(home[v], neutral[v], factor[v]);
+            away[v] = decayTowardNeutral(away[v], neutral[v], factor[v]);
+        }
+
+        for (std::size_t v = 0; v < count; v++) {
+            curves[v].home_momentum[tick] = home[v];
+            curves[v].away_momentum[tick] = away[v];
+        }
+    }
+}
+
+void MomentumWhatIfEngine::setTickInterval(float interval) {
+    if (interval > 0.0f) {
+        tick_interval = interval;
+    }
+}
+
+float MomentumWhatIfEngine::getTickInterval() const {
+    return tick_interval;
+}
+
+void MomentumWhatIfEngine::setWorkerCount(unsigned workers) {
+    worker_count = workers;
+}
+
+unsigned MomentumWhatIfEngine::getWorkerCount() const {
+    return worker_count;
+}
@@ -0,0 +1,95 @@
+#ifndef MOMENTUM_WHAT_IF_H
+#define MOMENTUM_WHAT_IF_H
+
+#include <cstddef>
+#include <vector>
+
+#include "momentum_model.h"
+
+/**
+ * one momentum-changing event as it was stored during a game
+ * the impact is the value GameEvent::calculateMomentumImpact produced live.
+ * timestamps are doubles so a whole game of fixed float steps adds up
+ * exactly and every event maps back to the tick it happened in
+ */
+struct RecordedEvent {
+    double timestamp;
+    float momentum_impact;
+    bool is_home_team_event;
+};
+
+/**
+ * a recorded game: the starting momentum of both teams plus every
+ * momentum event in time order
+ */
+class GameRecording {
+private:
+    float initial_home_momentum;
+    float initial_away_momentum;
+    double duration;
+    std::vector<RecordedEvent> events;
+
+public:
+    // constructor
+    GameRecording(float initialHome = 50.0f, float initialAway = 50.0f);
+
+    // recording
+    void recordEvent(double timestamp, float impact, bool isHomeTeamEvent);
+    void setDuration(double duration);
+    void clear();
+
+    // recording queries
+    float getInitialHomeMomentum() const;
+    float getInitialAwayMomentum() const;
+    double getDuration() const;
+    const std::vector<RecordedEvent>& getEvents() const;
+};
+
+/**
+ * momentum of both teams sampled once per replay tick
+ * sample 0 is the initial state; the last sample is the first tick end at
+ * or after both the duration and the last event
+ */
+struct MomentumCurve {
+    std::vector<float> home_momentum;
+    std::vector<float> away_momentum;
+};
+
+/**
+ * replays a recorded game against many parameter variants at once
+ *
+ * variants are laid out one per SIMD lane (structure of arrays) and
+ * stepped together, so the event stream is walked once per batch rather
+ * than once per variant. large sweeps are split into batches that run on
+ * worker threads. an event is applied before the decay of the tick it
+ * falls in, matching CrowdMomentumSystem stepping at the same interval.
+ * the tick is found by dividing the timestamp by the interval, never by
+ * comparing against an accumulated clock.
+ */
+class MomentumWhatIfEngine {
+private:
+    float tick_interval;
+    unsigned worker_count;
+
+    std::size_t getEventTick(double timestamp) const;
+    void runBatch(const GameRecording& recording, const MomentumParams* variants,
+                  std::size_t count, MomentumCurve* curves) const;
+
+public:
+    // constructor
+    explicit MomentumWhatIfEngine(float tickInterval = 1.0f);
+
+    // replay
+    std::vector<MomentumCurve> runVariants(const GameRecording& recording,
+                                           const std::vector<MomentumParams>& variants) const;
+    MomentumCurve run(const GameRecording& recording, const MomentumParams& params) const;
+    std::size_t getSampleCount(const GameRecording& recording) const;
+
+    // configuration
+    void setTickInterval(float interval);
+    float getTickInterval() const;
+    void setWorkerCount(unsigned workers);   // 0 = one per hardware thread
+    unsigned getWorkerCount() const;
+};
+
+#endif
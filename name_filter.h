@@ -0,0 +1,102 @@
+#ifndef NAME_FILTER_H
+#define NAME_FILTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory_accounting.h"
+
+// counting bloom filter over item name hashes, so lookups of names that are
+// not stocked can be turned away without scanning the items.
+//
+// each name sets kProbes 4-bit counters picked by double hashing, by default
+// at 16 counters per expected name, which lets about 1 in 200 misses
+// through; 8 per name halves the size and lets about 1 in 30 through.
+// counters rather than bits allow removing a name when its stock line goes
+// away; a counter that reaches 15 sticks there, since it no longer knows
+// how many names share it. the owner rebuilds the filter at a larger
+// capacity once it holds more names than it was sized for.
+class NameFilter {
+private:
+    static constexpr int kProbes = 3;
+    static constexpr size_t kCountersPerName = 16;
+    static constexpr uint64_t kCounterMax = 15;
+
+    TaggedVector<uint64_t, MemoryTag::INVENTORY_ITEMS> words;      // 16 counters per word
+    size_t counter_mask;
+    size_t capacity;
+    size_t counters_per_name;
+
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 31;
+        value *= 0x7fb5d329728ea185ULL;
+        value ^= value >> 27;
+        value *= 0x81dadef4bc2dd44dULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    template<typename Visit>
+    void for_each_probe(uint64_t name_hash, Visit &&visit) const {
+        uint64_t hash = mix(name_hash);
+        size_t h1 = static_cast<size_t>(hash);
+        size_t h2 = static_cast<size_t>(hash >> 32) | 1;
+        for (int i = 0; i < kProbes; i++) {
+            size_t counter = (h1 + static_cast<size_t>(i) * h2) & counter_mask;
+            visit(counter / 16, static_cast<unsigned>(counter % 16) * 4);
+        }
+    }
+
+public:
+    explicit NameFilter(size_t capacity = 64, size_t counters_per_name = kCountersPerName) :
+            words{},
+            counter_mask{0},
+            capacity{0},
+            counters_per_name{std::max<size_t>(1, counters_per_name)} {
+        reset(capacity);
+    }
+
+    // empties the filter and sizes it for capacity names
+    void reset(size_t new_capacity) {
+        size_t counters = 64;
+        while (counters < new_capacity * counters_per_name) {
+            counters *= 2;
+        }
+        words.assign(counters / 16, 0);
+        counter_mask = counters - 1;
+        capacity = new_capacity;
+    }
+
+    void add(uint64_t name_hash) {
+        for_each_probe(name_hash, [&](size_t word, unsigned shift) {
+            if (((words[word] >> shift) & 0xf) < kCounterMax) {
+                words[word] += uint64_t{1} << shift;
+            }
+        });
+    }
+
+    void remove(uint64_t name_hash) {
+        for_each_probe(name_hash, [&](size_t word, unsigned shift) {
+            uint64_t count = (words[word] >> shift) & 0xf;
+            if (count > 0 && count < kCounterMax) {
+                words[word] -= uint64_t{1} << shift;
+            }
+        });
+    }
+
+    // false means the name is certainly absent
+    bool may_contain(uint64_t name_hash) const {
+        bool present = true;
+        for_each_probe(name_hash, [&](size_t word, unsigned shift) {
+            present &= ((words[word] >> shift) & 0xf) != 0;
+        });
+        return present;
+    }
+
+    size_t get_capacity() const {
+        return capacity;
+    }
+};
+
+#endif
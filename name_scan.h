@@ -0,0 +1,120 @@
+#ifndef NAME_SCAN_H
+#define NAME_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memory_accounting.h"
+
+// 8-byte scan key of a name: its length (capped at 255), then the name
+// itself, zero padded, when it fits in 7 bytes, else its first 3 bytes and
+// 32 bits of its hash. equal keys mean equal names for names of up to 7
+// bytes; longer names still need a full compare. the hash bits stand in for
+// the rest of the name because item names tend to share both a prefix
+// ("item-") and a suffix ("-new"), which raw bytes would not tell apart.
+struct NameKey {
+    static constexpr size_t kNameBytes = 7;
+    static constexpr size_t kHeadBytes = 3;
+
+    static uint64_t make(const char *name, size_t length, uint64_t name_hash) {
+        uint8_t bytes[8] = {};
+        bytes[0] = static_cast<uint8_t>(length < 255 ? length : 255);
+        if (length <= kNameBytes) {
+            std::memcpy(bytes + 1, name, length);
+        } else {
+            std::memcpy(bytes + 1, name, kHeadBytes);
+            uint32_t hash_bits = static_cast<uint32_t>(name_hash >> 32);
+            std::memcpy(bytes + 1 + kHeadBytes, &hash_bits, sizeof(hash_bits));
+        }
+        uint64_t key;
+        std::memcpy(&key, bytes, sizeof(key));
+        return key;
+    }
+
+    // true when a key match alone proves the names equal
+    static bool is_exact(size_t length) {
+        return length <= kNameBytes;
+    }
+};
+
+// the scan keys of a list of names, packed contiguously in the same order,
+// so a linear search reads 8 bytes per name instead of every Item and
+// compares several keys per vector instruction.
+class PackedNameKeys {
+private:
+    TaggedVector<uint64_t, MemoryTag::INVENTORY_ITEMS> keys;
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    PackedNameKeys() :
+            keys{} {
+
+    }
+
+    void push_back(uint64_t key) {
+        keys.push_back(key);
+    }
+
+    void erase(size_t index) {
+        keys.erase(keys.begin() + static_cast<long>(index));
+    }
+
+    size_t size() const {
+        return keys.size();
+    }
+
+    // first index at or after start whose key equals query, npos if none.
+    // eight keys per step with a single branch on the combined mask
+    size_t find(uint64_t query, size_t start = 0) const {
+        const size_t count = keys.size();
+        const uint64_t *data = keys.data();
+        size_t i = start;
+#if defined(__AVX2__)
+        const __m256i pattern = _mm256_set1_epi64x(static_cast<long long>(query));
+        for (; i + 8 <= count; i += 8) {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 4));
+            const unsigned matches =
+                    static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(low, pattern)))) |
+                    static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(high, pattern))))
+                    << 4;
+            if (matches != 0) {
+                return i + static_cast<size_t>(__builtin_ctz(matches));
+            }
+        }
+#elif defined(__SSE2__)
+        // no 64-bit compare before SSE4.1: a key matches when both of its
+        // 32-bit halves do, i.e. both of its bits in the mask are set
+        const __m128i pattern = _mm_set1_epi64x(static_cast<long long>(query));
+        for (; i + 8 <= count; i += 8) {
+            unsigned halves = 0;
+            for (unsigned k = 0; k < 4; k++) {
+                const __m128i pair = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 2 * k));
+                halves |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(pair, pattern))))
+                        << (4 * k);
+            }
+            const unsigned matches = halves & (halves >> 1) & 0x5555u;
+            if (matches != 0) {
+                return i + static_cast<size_t>(__builtin_ctz(matches)) / 2;
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            if (data[i] == query) {
+                return i;
+            }
+        }
+        return npos;
+    }
+};
+
+#endif
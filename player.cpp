@@ -0,0 +1,220 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// base + base * modifier, as a single FMA where the target has one;
+// std::fma without hardware support is a slow library call
+inline float applyModifier(float base, float modifier) {
+#if defined(__FMA__)
+    return std::fma(base, modifier, base);
+#else
+    return base + base * modifier;
+#endif
+}
+
+} // namespace
+
+Player::Player(const std::string& id, const std::string& name, Team* team, Position pos)
+    : player_id(makeTaggedName(id)),
+      player_name(makeTaggedName(name)),
+      team(team),
+      position(pos),
+      base_stats{50.0f, 50.0f, 50.0f, 50.0f, 50.0f},
+      current_stats{50.0f, 50.0f, 50.0f, 50.0f, 50.0f},
+      composure_level(0.5f),
+      momentum_immune(false),
+      experience(kNeutralExperience),
+      sensitivity{},
+      modifier_slot(kNoModifierSlot),
+      momentum_system(nullptr),
+      effect_modifiers{} {
+    refreshSensitivity();
+}
+
+Player::~Player() {
+    // the system would otherwise keep updating a freed player every tick
+    if (momentum_system != nullptr) {
+        momentum_system->unregisterPlayer(*this);
+    }
+}
+
+void Player::applyEffect(MomentumEffect* effect) {
+    if (effect == nullptr ||
+        std::find(current_effects.begin(), current_effects.end(), effect) != current_effects.end()) {
+        return;
+    }
+    current_effects.push_back(effect);
+    recalculateStats();
+}
+
+void Player::removeEffect(MomentumEffect* effect) {
+    auto it = std::find(current_effects.begin(), current_effects.end(), effect);
+    if (it != current_effects.end()) {
+        current_effects.erase(it);
+        recalculateStats();
+    }
+}
+
+void Player::updateEffects(float delta_time) {
+    // effects are shared by the whole team and ticked by their owner; the
+    // player only drops the ones that ran out
+    (void)delta_time;
+    current_effects.erase(std::remove_if(current_effects.begin(), current_effects.end(),
+                                         [](const MomentumEffect* e) { return !e->isActive(); }),
+                          current_effects.end());
+    recalculateStats();
+}
+
+void Player::clearAllEffects() {
+    current_effects.clear();
+    recalculateStats();
+}
+
+void Player::computeEffectModifiers(float* modifiers) const {
+    // effects of one type add up rather than compound, and never exceed a
+    // full-strength effect, so piling effects cannot run a stat away.
+    // penalties count against the stat and an active team composure mode
+    // halves them; the player's own composure is in the sensitivity curve.
+    const float penalty = team != nullptr && team->isComposureModeActive() ? -0.5f : -1.0f;
+
+#if defined(__SSE2__)
+    // each effect is added to its lane of the padded row under a compare
+    // mask, so the sums never leave the registers
+    const __m128i lanes_low = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i lanes_high = _mm_setr_epi32(4, 5, 6, 7);
+    __m128 sums_low = _mm_setzero_ps();
+    __m128 sums_high = _mm_setzero_ps();
+    for (const MomentumEffect* effect : current_effects) {
+        const __m128i type = _mm_set1_epi32(static_cast<int>(effect->getEffectType()));
+        const __m128 strength = _mm_set1_ps(effect->getEffectStrength());
+        sums_low = _mm_add_ps(sums_low, _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lanes_low, type)), strength));
+        sums_high = _mm_add_ps(sums_high, _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lanes_high, type)), strength));
+    }
+    // lanes 3, 4 and 5 are the penalties
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign_low = _mm_setr_ps(1.0f, 1.0f, 1.0f, penalty);
+    const __m128 sign_high = _mm_setr_ps(penalty, penalty, 1.0f, 1.0f);
+    const __m128 low = _mm_mul_ps(_mm_mul_ps(_mm_min_ps(sums_low, one), sign_low),
+                                  _mm_loadu_ps(sensitivity.coefficients));
+    const __m128 high = _mm_mul_ps(_mm_mul_ps(_mm_min_ps(sums_high, one), sign_high),
+                                   _mm_loadu_ps(sensitivity.coefficients + 4));
+    _mm_storeu_ps(modifiers, low);
+    _mm_storeu_ps(modifiers + 4, high);
+#else
+    float sums[kModifierStride] = {};
+    for (const MomentumEffect* effect : current_effects) {
+        sums[static_cast<std::size_t>(effect->getEffectType())] += effect->getEffectStrength();
+    }
+    for (std::size_t lane = 0; lane < kModifierStride; lane++) {
+        const bool is_penalty = lane == static_cast<std::size_t>(EffectType::SNAP_TIMING_PENALTY) ||
+                                lane == static_cast<std::size_t>(EffectType::FOCUS_REDUCTION) ||
+                                lane == static_cast<std::size_t>(EffectType::FALSE_START_INCREASE);
+        modifiers[lane] = std::min(1.0f, sums[lane]) * (is_penalty ? penalty : 1.0f) * sensitivity.coefficients[lane];
+    }
+#endif
+}
+
+void Player::refreshSensitivity() {
+    sensitivity = computeMomentumSensitivity(position, composure_level, experience, momentum_immune);
+}
+
+void Player::recalculateStats() {
+    // modifiers are effect totals times sensitivity, lane by lane; an
+    // immune player's zero coefficients leave every stat at its base value
+    computeEffectModifiers(effect_modifiers);
+
+    // one FMA per stat over the sum of the modifiers on it
+    auto modifier = [&](EffectType type) {
+        return effect_modifiers[static_cast<std::size_t>(type)];
+    };
+    current_stats.speed = applyModifier(base_stats.speed, modifier(EffectType::REACTION_TIME_BOOST));
+    current_stats.awareness = applyModifier(base_stats.awareness, modifier(EffectType::REACTION_TIME_BOOST) +
+                                                                  modifier(EffectType::SNAP_TIMING_PENALTY));
+    current_stats.accuracy = applyModifier(base_stats.accuracy, modifier(EffectType::ACCURACY_BOOST) +
+                                                                modifier(EffectType::FOCUS_REDUCTION));
+    current_stats.strength = applyModifier(base_stats.strength, modifier(EffectType::BLOCKING_EFFICIENCY));
+    current_stats.composure = applyModifier(base_stats.composure, modifier(EffectType::FALSE_START_INCREASE));
+}
+
+void Player::accumulateModifiers(MomentumModifierTable& table) const {
+    if (modifier_slot == kNoModifierSlot) {
+        return;
+    }
+    // the modifiers the stats were last recalculated from (the system
+    // refreshes effects just before), written as one whole row
+    table.setRow(modifier_slot, effect_modifiers);
+}
+
+PlayerStats Player::getModifiedStats() const {
+    return current_stats;
+}
+
+PlayerStats Player::getBaseStats() const {
+    return base_stats;
+}
+
+float Player::getComposureLevel() const {
+    return composure_level;
+}
+
+Position Player::getPosition() const {
+    return position;
+}
+
+Team* Player::getTeam() const {
+    return team;
+}
+
+std::string Player::getName() const {
+    return toString(player_name);
+}
+
+std::string Player::getId() const {
+    return toString(player_id);
+}
+
+void Player::setComposureLevel(float level) {
+    composure_level = std::min(1.0f, std::max(0.0f, level));
+    refreshSensitivity();
+    recalculateStats();
+}
+
+void Player::setMomentumImmune(bool immune) {
+    momentum_immune = immune;
+    refreshSensitivity();
+    recalculateStats();
+}
+
+void Player::setBaseStats(const PlayerStats& stats) {
+    base_stats = stats;
+    recalculateStats();
+}
+
+void Player::setExperience(float seasons) {
+    experience = std::max(0.0f, seasons);
+    refreshSensitivity();
+    recalculateStats();
+}
+
+float Player::getExperience() const {
+    return experience;
+}
+
+const MomentumSensitivity& Player::getSensitivity() const {
+    return sensitivity;
+}
+
+void Player::setModifierSlot(std::uint32_t slot) {
+    modifier_slot = slot;
+}
+
+void Player::setMomentumSystem(CrowdMomentumSystem* system) {
+    momentum_system = system;
+}
@@ -0,0 +1,220 @@
+#ifndef SALES_ANALYTICS_H
+#define SALES_ANALYTICS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "inventory_digest.h"
+#include "memory_accounting.h"
+
+enum class SalesWindow {
+    MINUTE,
+    HOUR,
+    DAY
+};
+
+// units and revenue of one item over a window
+struct SalesTotals {
+    std::string name;
+    uint64_t units;
+    double revenue;
+};
+
+// per-item sales history for the dashboard.
+//
+// each item that ever sold gets three rings of time buckets: the last minute
+// in 5 s buckets, the last hour in 5 min buckets and the last day in 1 h
+// buckets. a sale adds to the current bucket of each ring, resetting a
+// bucket first if it still holds an older period, so recording is O(1) and
+// a window total is a sum over one ring. windows are as fine as their
+// buckets: "last hour" is the current 5 min bucket plus the 11 before it.
+//
+// lifetime units sold are kept in an indexed max-heap, so a sale is a
+// sift-up and the top k sellers come out in O(k log k) without a sort.
+class SalesAnalytics {
+private:
+    struct Bucket {
+        uint64_t period;        // which bucket-wide period the counts are for
+        uint64_t units;
+        double revenue;
+    };
+
+    struct Ring {
+        uint64_t bucket_ms;
+        size_t bucket_count;
+        size_t first_bucket;    // offset of this ring in ItemSales::buckets
+    };
+
+    static constexpr size_t kRingCount = 3;
+    static constexpr Ring kRings[kRingCount] = {
+            {5000, 12, 0},          // minute
+            {300000, 12, 12},       // hour
+            {3600000, 24, 24}       // day
+    };
+    static constexpr size_t kBucketCount = 48;
+
+    struct ItemSales {
+        TaggedName name;
+        uint64_t units;
+        double revenue;
+        size_t heap_position;
+        Bucket buckets[kBucketCount];
+    };
+
+    // name hash to slot; the name itself is only kept in ItemSales
+    using SlotsByHash = std::unordered_multimap<uint64_t, size_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                                TaggedAllocator<std::pair<const uint64_t, size_t>,
+                                                                MemoryTag::INVENTORY_ITEMS>>;
+
+    TaggedVector<ItemSales, MemoryTag::INVENTORY_ITEMS> sales;
+    SlotsByHash sales_by_name;
+    TaggedVector<size_t, MemoryTag::INVENTORY_ITEMS> heap;     // indexes into sales, most units first
+
+    bool heap_less(size_t a, size_t b) const {
+        return sales[heap[a]].units < sales[heap[b]].units;
+    }
+
+    void heap_swap(size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        sales[heap[a]].heap_position = a;
+        sales[heap[b]].heap_position = b;
+    }
+
+    size_t find_slot(const std::string &name, uint64_t name_hash) const {
+        auto range = sales_by_name.equal_range(name_hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const TaggedName &stored = sales[it->second].name;
+            if (stored.size() == name.size() && stored.compare(0, stored.size(), name.data(), name.size()) == 0) {
+                return it->second;
+            }
+        }
+        return npos;
+    }
+
+    size_t find_slot(const std::string &name) const {
+        return find_slot(name, InventoryDigest::hash_name(name.data(), name.size()));
+    }
+
+    // units only grow, so an entry only ever moves up
+    void sift_up(size_t position) {
+        while (position > 0) {
+            size_t parent = (position - 1) / 2;
+            if (!heap_less(parent, position)) {
+                break;
+            }
+            heap_swap(parent, position);
+            position = parent;
+        }
+    }
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    SalesAnalytics() :
+            sales{},
+            sales_by_name{},
+            heap{} {
+
+    }
+
+    // history slot of an item name, created on first use. callers keep the
+    // slot so later sales skip the name lookup
+    size_t slot_for(const std::string &name) {
+        const uint64_t name_hash = InventoryDigest::hash_name(name.data(), name.size());
+        size_t slot = find_slot(name, name_hash);
+        if (slot != npos) {
+            return slot;
+        }
+        slot = sales.size();
+        sales.push_back(ItemSales{makeTaggedName(name), 0, 0, heap.size(), {}});
+        sales_by_name.emplace(name_hash, slot);
+        heap.push_back(slot);
+        return slot;
+    }
+
+    void record_sale(size_t slot, int units, float revenue, uint64_t now_ms) {
+        ItemSales &item = sales[slot];
+        for (const Ring &ring : kRings) {
+            uint64_t period = now_ms / ring.bucket_ms;
+            Bucket &bucket = item.buckets[ring.first_bucket + period % ring.bucket_count];
+            if (bucket.period != period) {
+                bucket = Bucket{period, 0, 0};
+            }
+            bucket.units += static_cast<uint64_t>(units);
+            bucket.revenue += revenue;
+        }
+        record_lifetime_sale(slot, units, revenue);
+    }
+
+    // lifetime totals and the top sellers only, without a time
+    void record_lifetime_sale(size_t slot, int units, float revenue) {
+        ItemSales &item = sales[slot];
+        item.units += static_cast<uint64_t>(units);
+        item.revenue += revenue;
+        sift_up(item.heap_position);
+    }
+
+    // units and revenue of one item over the window ending at now_ms
+    SalesTotals window_totals(const std::string &name, SalesWindow window, uint64_t now_ms) const {
+        SalesTotals totals{name, 0, 0};
+        size_t slot = find_slot(name);
+        if (slot == npos) {
+            return totals;
+        }
+        const ItemSales &item = sales[slot];
+        const Ring &ring = kRings[static_cast<size_t>(window)];
+        uint64_t current = now_ms / ring.bucket_ms;
+        for (size_t i = 0; i < ring.bucket_count; i++) {
+            const Bucket &bucket = item.buckets[ring.first_bucket + i];
+            // a bucket not reset since an older revolution is stale
+            if (bucket.period <= current && current - bucket.period < ring.bucket_count) {
+                totals.units += bucket.units;
+                totals.revenue += bucket.revenue;
+            }
+        }
+        return totals;
+    }
+
+    SalesTotals lifetime_totals(const std::string &name) const {
+        size_t slot = find_slot(name);
+        if (slot == npos) {
+            return SalesTotals{name, 0, 0};
+        }
+        const ItemSales &item = sales[slot];
+        return SalesTotals{name, item.units, item.revenue};
+    }
+
+    // the k items with the most units sold, best first. walks the top of the
+    // heap with a small frontier instead of sorting every item
+    std::vector<SalesTotals> top_sellers(size_t k) const {
+        std::vector<SalesTotals> top;
+        std::vector<size_t> frontier;       // heap positions, itself a max-heap
+        auto frontier_less = [this](size_t a, size_t b) { return heap_less(a, b); };
+        if (!heap.empty()) {
+            frontier.push_back(0);
+        }
+        while (top.size() < k && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), frontier_less);
+            size_t position = frontier.back();
+            frontier.pop_back();
+            const ItemSales &item = sales[heap[position]];
+            top.push_back(SalesTotals{toString(item.name), item.units, item.revenue});
+            for (size_t child = 2 * position + 1; child <= 2 * position + 2 && child < heap.size(); child++) {
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), frontier_less);
+            }
+        }
+        return top;
+    }
+
+    size_t item_count() const {
+        return sales.size();
+    }
+};
+
+#endif
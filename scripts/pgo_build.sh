@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# Profile-guided optimization pipeline.
+#
+# Builds a plain release tree and a PGO tree, trains the instrumented PGO
+# binaries on bench/pgo_training (a simulated game with event bursts plus
+# an inventory trading session), rebuilds with the collected profiles and
+# benchmarks both trees on the same workload.
+#
+# usage: scripts/pgo_build.sh [build-root] [benchmark-runs]
+
+set -euo pipefail
+
+src="$(cd "$(dirname "$0")/.." && pwd)"
+root="${1:-$src/build-pgo}"
+runs="${2:-5}"
+jobs="$(nproc 2>/dev/null || echo 4)"
+
+baseline="$root/baseline"
+pgo="$root/pgo"
+profiles="$pgo/profiles"
+report="$root/pgo_report.txt"
+
+configure() {
+    local dir="$1"
+    shift
+    cmake -S "$src" -B "$dir" -DCMAKE_BUILD_TYPE=Release "$@" > /dev/null
+}
+
+echo "== baseline build"
+configure "$baseline" -DMOMENTUM_PGO=OFF
+cmake --build "$baseline" -j "$jobs"
+
+echo "== instrumented build"
+rm -rf "$profiles"
+configure "$pgo" -DMOMENTUM_PGO=GENERATE -DMOMENTUM_PGO_DIR="$profiles"
+cmake --build "$pgo" -j "$jobs" --clean-first
+
+echo "== training"
+# a few seeds so the profile is not tuned to a single game
+for seed in 1 2 3; do
+    "$pgo/pgo_training" "$seed" > /dev/null 2>&1
+done
+
+cxx="$(sed -n 's/^CMAKE_CXX_COMPILER:[A-Z]*=//p' "$pgo/CMakeCache.txt")"
+if "$cxx" --version 2>/dev/null | grep -qi clang; then
+    llvm-profdata merge -o "$profiles/default.profdata" "$profiles"/*.profraw
+fi
+
+echo "== optimized build"
+configure "$pgo" -DMOMENTUM_PGO=USE -DMOMENTUM_PGO_DIR="$profiles"
+cmake --build "$pgo" -j "$jobs" --clean-first
+
+# best of N runs per phase, "<phase> <ms>" sorted by phase
+benchmark() {
+    for _ in $(seq "$runs"); do
+        "$1/pgo_training" 42 2> /dev/null
+    done | awk '!($1 in best) || $2 < best[$1] { best[$1] = $2 }
+                END { for (phase in best) print phase, best[phase] }' | sort
+}
+
+echo "== benchmark ($runs runs each, best time)"
+benchmark "$baseline" > "$root/baseline.txt"
+benchmark "$pgo" > "$root/pgo.txt"
+
+join "$root/baseline.txt" "$root/pgo.txt" | awk '
+    BEGIN { printf "%-20s %12s %12s %9s\n", "phase", "baseline ms", "pgo ms", "speedup" }
+    { printf "%-20s %12.3f %12.3f %8.2fx\n", $1, $2, $3, ($3 > 0 ? $2 / $3 : 0) }
+' | tee "$report"
+
+echo "report written to $report"
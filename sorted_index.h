@@ -0,0 +1,119 @@
+#ifndef SORTED_INDEX_H
+#define SORTED_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory_accounting.h"
+
+// ordered secondary index from a key to item ids, kept as a list of small
+// sorted blocks like the leaf level of a B+ tree. a block is found by binary
+// search on the last entry of each block, and an insert or erase only moves
+// entries within one block, so updates stay cheap as the inventory grows.
+// equal keys are ordered by id, so every entry is unique.
+template<typename Key>
+class SortedIndex {
+private:
+    struct Entry {
+        Key key;
+        uint64_t id;
+
+        bool operator<(const Entry &other) const {
+            return key < other.key || (!(other.key < key) && id < other.id);
+        }
+    };
+
+    using Block = TaggedVector<Entry, MemoryTag::INVENTORY_ITEMS>;
+
+    // a full block splits into two half-full ones
+    static constexpr size_t kMaxBlockSize = 512;
+
+    TaggedVector<Block, MemoryTag::INVENTORY_ITEMS> blocks;
+    size_t count;
+
+    // first block whose last entry is not below entry, else the last block
+    size_t block_for(const Entry &entry) const {
+        auto found = std::lower_bound(blocks.begin(), blocks.end(), entry,
+                                      [](const Block &block, const Entry &e) { return block.back() < e; });
+        if (found == blocks.end()) {
+            return blocks.size() - 1;
+        }
+        return static_cast<size_t>(found - blocks.begin());
+    }
+
+public:
+    SortedIndex() :
+            blocks{},
+            count{0} {
+
+    }
+
+    void insert(Key key, uint64_t id) {
+        Entry entry{key, id};
+        count++;
+        if (blocks.empty()) {
+            blocks.emplace_back(1, entry);
+            return;
+        }
+        size_t b = block_for(entry);
+        Block &block = blocks[b];
+        block.insert(std::lower_bound(block.begin(), block.end(), entry), entry);
+        if (block.size() >= kMaxBlockSize) {
+            Block upper(block.begin() + kMaxBlockSize / 2, block.end());
+            block.resize(kMaxBlockSize / 2);
+            blocks.insert(blocks.begin() + static_cast<long>(b) + 1, std::move(upper));
+        }
+    }
+
+    bool erase(Key key, uint64_t id) {
+        if (blocks.empty()) {
+            return false;
+        }
+        Entry entry{key, id};
+        size_t b = block_for(entry);
+        Block &block = blocks[b];
+        auto found = std::lower_bound(block.begin(), block.end(), entry);
+        if (found == block.end() || found->id != id || entry < *found) {
+            return false;
+        }
+        block.erase(found);
+        count--;
+        if (block.empty()) {
+            blocks.erase(blocks.begin() + static_cast<long>(b));
+        }
+        return true;
+    }
+
+    void update(Key old_key, Key new_key, uint64_t id) {
+        if (erase(old_key, id)) {
+            insert(new_key, id);
+        }
+    }
+
+    // calls visit(key, id) for every entry with min <= key <= max, in key order
+    template<typename Visit>
+    void for_range(Key min, Key max, Visit &&visit) const {
+        if (blocks.empty() || max < min) {
+            return;
+        }
+        Entry first{min, 0};
+        size_t start = block_for(first);
+        for (size_t b = start; b < blocks.size(); b++) {
+            const Block &block = blocks[b];
+            auto it = b == start ? std::lower_bound(block.begin(), block.end(), first) : block.begin();
+            for (; it != block.end(); ++it) {
+                if (max < it->key) {
+                    return;
+                }
+                visit(it->key, it->id);
+            }
+        }
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+#endif
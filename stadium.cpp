@@ -0,0 +1,80 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+Stadium::Stadium(const std::string& id, const std::string& name, int capacity, VenueType type)
+    : stadium_id(makeTaggedName(id)),
+      stadium_name(makeTaggedName(name)),
+      capacity(capacity),
+      venue_type(type),
+      rivalry_factor(0.0f),
+      home_field_advantage(0.1f) {
+    crowd = std::make_unique<Crowd>(this);
+}
+
+Stadium::~Stadium() {
+}
+
+Crowd* Stadium::getCrowd() const {
+    return crowd.get();
+}
+
+int Stadium::getCapacity() const {
+    return capacity;
+}
+
+VenueType Stadium::getVenueType() const {
+    return venue_type;
+}
+
+std::string Stadium::getName() const {
+    return toString(stadium_name);
+}
+
+std::string Stadium::getId() const {
+    return toString(stadium_id);
+}
+
+float Stadium::getRivalryMultiplier() const {
+    return 1.0f + rivalry_factor;
+}
+
+float Stadium::getVenueBonus() const {
+    // enclosed and bigger venues hold the noise better
+    switch (venue_type) {
+        case VenueType::SMALL_STADIUM:   return 0.9f;
+        case VenueType::MEDIUM_STADIUM:  return 1.0f;
+        case VenueType::LARGE_STADIUM:   return 1.1f;
+        case VenueType::DOME_STADIUM:    return 1.15f;
+        case VenueType::OUTDOOR_STADIUM: return 1.0f;
+    }
+    return 1.0f;
+}
+
+float Stadium::getHomeFieldAdvantage() const {
+    return home_field_advantage;
+}
+
+void Stadium::setRivalryFactor(float factor) {
+    rivalry_factor = std::max(0.0f, factor);
+}
+
+void Stadium::setHomeFieldAdvantage(float advantage) {
+    home_field_advantage = advantage;
+}
+
+void Stadium::initializeCrowd(Team* homeTeam, Team* awayTeam) {
+    // roughly one section per 2000 seats, with an eighth given to visitors
+    const int sections = std::max(8, capacity / 2000);
+    const int away_sections = awayTeam != nullptr ? std::max(1, sections / 8) : 0;
+    const int per_section = capacity / sections;
+
+    MomentumEventBus* bus = crowd ? crowd->getEventBus() : nullptr;
+    crowd = std::make_unique<Crowd>(this, 0);
+    crowd->setEventBus(bus);
+    for (int i = 0; i < sections; i++) {
+        crowd->addCrowdSection(i < sections - away_sections ? homeTeam : awayTeam, per_section);
+    }
+    crowd->rebuildContagionGraph(sections >= 24 ? 3 : 1);
+    crowd->generateNoise();
+}
@@ -0,0 +1,207 @@
+#ifndef STOCK_KERNELS_H
+#define STOCK_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memory_accounting.h"
+
+// kernels over the inventory's quantity and price columns.
+//
+// the valuation multiplies in double, where an int32 quantity times a float
+// price loses at most the last bit, and sums with Kahan compensation in
+// every lane, so a million-item total does not drift with the order of the
+// items. selections write one bit per item into a bitmap of
+// (count + 63) / 64 words, bit i of word i / 64 for item i, and return how
+// many bits they set.
+
+// a running Kahan sum: total plus the low-order part lost so far
+struct KahanSum {
+    double sum = 0;
+    double compensation = 0;
+
+    void add(double value) {
+        double y = value - compensation;
+        double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+};
+
+// sum of quantity * price
+inline double stock_value(const int32_t *quantities, const float *prices, size_t count) {
+    size_t i = 0;
+    KahanSum total;
+#if defined(__AVX2__)
+    __m256d sum = _mm256_setzero_pd();
+    __m256d compensation = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        const __m256d quantity = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(quantities + i)));
+        const __m256d price = _mm256_cvtps_pd(_mm_loadu_ps(prices + i));
+        const __m256d y = _mm256_sub_pd(_mm256_mul_pd(quantity, price), compensation);
+        const __m256d t = _mm256_add_pd(sum, y);
+        compensation = _mm256_sub_pd(_mm256_sub_pd(t, sum), y);
+        sum = t;
+    }
+    alignas(32) double sums[4];
+    alignas(32) double compensations[4];
+    _mm256_store_pd(sums, sum);
+    _mm256_store_pd(compensations, compensation);
+    for (int lane = 0; lane < 4; lane++) {
+        total.add(sums[lane]);
+        total.add(-compensations[lane]);
+    }
+#elif defined(__SSE2__)
+    __m128d sum = _mm_setzero_pd();
+    __m128d compensation = _mm_setzero_pd();
+    for (; i + 2 <= count; i += 2) {
+        const __m128d quantity = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(quantities + i)));
+        const __m128d price = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(prices + i))));
+        const __m128d y = _mm_sub_pd(_mm_mul_pd(quantity, price), compensation);
+        const __m128d t = _mm_add_pd(sum, y);
+        compensation = _mm_sub_pd(_mm_sub_pd(t, sum), y);
+        sum = t;
+    }
+    alignas(16) double sums[2];
+    alignas(16) double compensations[2];
+    _mm_store_pd(sums, sum);
+    _mm_store_pd(compensations, compensation);
+    for (int lane = 0; lane < 2; lane++) {
+        total.add(sums[lane]);
+        total.add(-compensations[lane]);
+    }
+#endif
+    for (; i < count; i++) {
+        total.add(static_cast<double>(quantities[i]) * static_cast<double>(prices[i]));
+    }
+    return total.sum;
+}
+
+// items with quantity < limit
+inline size_t select_quantity_below(const int32_t *quantities, size_t count, int32_t limit, uint64_t *bitmap) {
+    size_t selected = 0;
+    size_t i = 0;
+    for (size_t word = 0; word < (count + 63) / 64; word++) {
+        bitmap[word] = 0;
+    }
+#if defined(__AVX2__)
+    const __m256i bound = _mm256_set1_epi32(limit);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i quantity = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(quantities + i));
+        const uint64_t bits =
+                static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(bound, quantity))));
+        bitmap[i / 64] |= bits << (i % 64);
+        selected += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+#elif defined(__SSE2__)
+    const __m128i bound = _mm_set1_epi32(limit);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i quantity = _mm_loadu_si128(reinterpret_cast<const __m128i *>(quantities + i));
+        const uint64_t bits = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(bound, quantity))));
+        bitmap[i / 64] |= bits << (i % 64);
+        selected += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+#endif
+    for (; i < count; i++) {
+        if (quantities[i] < limit) {
+            bitmap[i / 64] |= uint64_t{1} << (i % 64);
+            selected++;
+        }
+    }
+    return selected;
+}
+
+// items with min_price <= price <= max_price
+inline size_t select_price_between(const float *prices, size_t count, float min_price, float max_price,
+                                   uint64_t *bitmap) {
+    size_t selected = 0;
+    size_t i = 0;
+    for (size_t word = 0; word < (count + 63) / 64; word++) {
+        bitmap[word] = 0;
+    }
+#if defined(__AVX2__)
+    const __m256 low = _mm256_set1_ps(min_price);
+    const __m256 high = _mm256_set1_ps(max_price);
+    for (; i + 8 <= count; i += 8) {
+        const __m256 price = _mm256_loadu_ps(prices + i);
+        const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(price, low, _CMP_GE_OQ), _mm256_cmp_ps(price, high, _CMP_LE_OQ));
+        const uint64_t bits = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        bitmap[i / 64] |= bits << (i % 64);
+        selected += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+#elif defined(__SSE2__)
+    const __m128 low = _mm_set1_ps(min_price);
+    const __m128 high = _mm_set1_ps(max_price);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 price = _mm_loadu_ps(prices + i);
+        const __m128 inside = _mm_and_ps(_mm_cmpge_ps(price, low), _mm_cmple_ps(price, high));
+        const uint64_t bits = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        bitmap[i / 64] |= bits << (i % 64);
+        selected += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+#endif
+    for (; i < count; i++) {
+        if (prices[i] >= min_price && prices[i] <= max_price) {
+            bitmap[i / 64] |= uint64_t{1} << (i % 64);
+            selected++;
+        }
+    }
+    return selected;
+}
+
+// the quantity and price of every item in contiguous arrays, in item order,
+// so whole-inventory valuations and filters stream two dense columns
+// instead of striding over Items.
+class StockColumns {
+private:
+    TaggedVector<int32_t, MemoryTag::INVENTORY_ITEMS> quantities;
+    TaggedVector<float, MemoryTag::INVENTORY_ITEMS> prices;
+
+public:
+    StockColumns() :
+            quantities{},
+            prices{} {
+
+    }
+
+    void push_back(int quantity, float price) {
+        quantities.push_back(quantity);
+        prices.push_back(price);
+    }
+
+    void erase(size_t index) {
+        quantities.erase(quantities.begin() + static_cast<long>(index));
+        prices.erase(prices.begin() + static_cast<long>(index));
+    }
+
+    void set_quantity(size_t index, int quantity) {
+        quantities[index] = quantity;
+    }
+
+    size_t size() const {
+        return quantities.size();
+    }
+
+    double total_value() const {
+        return stock_value(quantities.data(), prices.data(), quantities.size());
+    }
+
+    size_t select_quantity_below(int limit, std::vector<uint64_t> *bitmap) const {
+        bitmap->resize((quantities.size() + 63) / 64);
+        return ::select_quantity_below(quantities.data(), quantities.size(), limit, bitmap->data());
+    }
+
+    size_t select_price_between(float min_price, float max_price, std::vector<uint64_t> *bitmap) const {
+        bitmap->resize((prices.size() + 63) / 64);
+        return ::select_price_between(prices.data(), prices.size(), min_price, max_price, bitmap->data());
+    }
+};
+
+#endif
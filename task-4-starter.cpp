@@ -1,138 +1,44 @@
-#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
 #include <iostream>
-#include <utility>
-#include <vector>
 #include <climits>
 
-class Item {
-private:
-    std::string name;
-    int quantity;
-    float price;
+#include "inventory.h"
+#include "inventory_daemon.h"
 
-public:
-    Item(
-            std::string name,
-            int quantity,
-            float price
-    ) :
-            name{std::move(name)},
-            quantity{quantity},
-            price{price} {
+static InventoryDaemon *running_daemon = nullptr;
 
-    }
-
-    std::string get_name() const {
-        return name;
-    }
-
-    int get_quantity() const {
-        return quantity;
-    }
-
-    void set_quantity(int new_quantity) {
-        quantity = new_quantity;
-    }
-
-    float get_price() const {
-        return price;
-    }
-
-    bool is_match(const std::string &other) const {
-        return name == other;
-    }
-};
-
-class Inventory {
-private:
-    std::vector<Item> items;
-    float total_money;
-
-    static void display_data(Item &item) {
-        std::cout << "\nItem name: " << item.get_name();
-        std::cout << "\nQuantity: " << item.get_quantity();
-        std::cout << "\nPrice: " << item.get_price();
-    }
-
-public:
-    Inventory() :
-            items{},
-            total_money{0} {
-
-    }
-
-    void add_item() {
-        std::string name;
-        int quantity;
-        float price;
-
-        std::cin.ignore();
-        std::cout << "\nEnter item name: ";
-        std::cin >> name;
-        std::cout << "Enter quantity: ";
-        std::cin >> quantity;
-        std::cout << "Enter price: ";
-        std::cin >> price;
-
-        items.emplace_back(name, quantity, price);
-    }
-
-    void sell_item() {
-        std::string item_to_check;
-        std::cin.ignore();
-        std::cout << "\nEnter item name: ";
-        std::cin >> item_to_check;
-
-        for (size_t i = 0; i < items.size(); i++) {
-            if (items[i].is_match(item_to_check)) {
-                remove_item(i);
-                return;
-            }
-        }
-        std::cout << "\nThis item is not in your Inventory";
-    }
-
-    void remove_item(size_t item_index) {
-        int input_quantity;
-        Item &item = items[item_index];
-        std::cout << "\nEnter number of items to sell: ";
-        std::cin >> input_quantity;
-
-        int quantity = item.get_quantity();
-        if (input_quantity <= quantity) {
-            float price = item.get_price();
-            float money_earned = price * input_quantity;
-            int new_quantity = quantity - input_quantity;
-            item.set_quantity(new_quantity);
-            std::cout << "\nItems sold";
-            std::cout << "\nMoney received: " << money_earned;
-            total_money += money_earned;
+static void stop_daemon(int) {
+    running_daemon->stop();
+}
 
-            // lets remove item completely if quantity reaches 0
-            if (new_quantity == 0) {
-                items.erase(items.begin() + item_index);
-                std::cout << "\nItem completely removed from inventory.";
-            }
-        } else {
-            std::cout << "\nCannot sell more items than you have.";
-        }
+// daemon mode: inventory --serve <socket path> serves the inventory to local
+// clients over a Unix socket, inventory --serve - over stdin/stdout, with the
+// framed protocol in inventory_service.h
+static int serve(const char *path) {
+    InventoryDaemon daemon;
+    bool ready = std::strcmp(path, "-") == 0 ? daemon.add_connection(0, 1) : daemon.listen_on(path);
+    if (!ready) {
+        std::cerr << "cannot serve on " << path << ": " << std::strerror(errno) << "\n";
+        return 1;
     }
+    running_daemon = &daemon;
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, stop_daemon);
+    std::signal(SIGTERM, stop_daemon);
+    bool clean = daemon.run();
+    std::cerr << daemon.request_count() << " requests in " << daemon.batch_count() << " batches\n";
+    return clean ? 0 : 1;
+}
 
-    void list_items() {
-        if (items.empty()) {
-            std::cout << "\nInventory empty.";
-            return;
-        }
-
-        for (size_t i = 0; i < items.size(); i++) {
-            display_data(items[i]);
-            std::cout << "\n";
-        }
+// the interactive menu, or the daemon with --serve
+int main(int argc, char **argv) {
+    if (argc > 2 && std::strcmp(argv[1], "--serve") == 0) {
+        return serve(argv[2]);
     }
-};
 
-// no need to modify anything here
-int main() {
     int choice;
     Inventory inventory_system;
     std::cout << "Welcome to the inventory!";
@@ -0,0 +1,80 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+Team::Team(const std::string& id, const std::string& name, bool isHome)
+    : team_id(makeTaggedName(id)),
+      team_name(makeTaggedName(name)),
+      is_home_team(isHome),
+      composure_mode_active(false),
+      team_morale(50.0f) {
+}
+
+Team::~Team() {
+}
+
+void Team::addPlayer(std::unique_ptr<Player> player) {
+    if (player) {
+        players.push_back(std::move(player));
+    }
+}
+
+void Team::removePlayer(const std::string& player_id) {
+    players.erase(std::remove_if(players.begin(), players.end(),
+                                 [&](const std::unique_ptr<Player>& p) { return p->getId() == player_id; }),
+                  players.end());
+}
+
+std::vector<Player*> Team::getPlayers() const {
+    std::vector<Player*> roster;
+    roster.reserve(players.size());
+    for (const auto& player : players) {
+        roster.push_back(player.get());
+    }
+    return roster;
+}
+
+Player* Team::getPlayer(const std::string& player_id) const {
+    for (const auto& player : players) {
+        if (player->getId() == player_id) {
+            return player.get();
+        }
+    }
+    return nullptr;
+}
+
+std::string Team::getName() const {
+    return toString(team_name);
+}
+
+std::string Team::getId() const {
+    return toString(team_id);
+}
+
+Coach* Team::getCoach() const {
+    return coach.get();
+}
+
+void Team::activateComposureMode() {
+    composure_mode_active = true;
+}
+
+void Team::deactivateComposureMode() {
+    composure_mode_active = false;
+}
+
+bool Team::isComposureModeActive() const {
+    return composure_mode_active;
+}
+
+void Team::setMorale(float morale) {
+    team_morale = std::min(100.0f, std::max(0.0f, morale));
+}
+
+float Team::getMorale() const {
+    return team_morale;
+}
+
+void Team::setCoach(std::unique_ptr<Coach> newCoach) {
+    coach = std::move(newCoach);
+}
@@ -0,0 +1,76 @@
+#include "crowd_momentum_system.h"
+
+#include <algorithm>
+
+TeamComposureMode::TeamComposureMode(float duration, float effectiveness)
+    : is_active(false),
+      duration(duration),
+      remaining_time(0.0f),
+      effectiveness(effectiveness),
+      cooldown_time(90.0f),
+      cooldown_remaining(0.0f),
+      activating_coach(nullptr) {
+}
+
+void TeamComposureMode::activate(Coach* coach) {
+    if (!canActivate()) {
+        return;
+    }
+    is_active = true;
+    remaining_time = duration;
+    activating_coach = coach;
+}
+
+void TeamComposureMode::deactivate() {
+    if (!is_active) {
+        return;
+    }
+    is_active = false;
+    remaining_time = 0.0f;
+    cooldown_remaining = cooldown_time;
+    activating_coach = nullptr;
+}
+
+void TeamComposureMode::update(float delta_time) {
+    if (is_active) {
+        remaining_time -= delta_time;
+        if (remaining_time <= 0.0f) {
+            deactivate();
+        }
+    } else if (cooldown_remaining > 0.0f) {
+        cooldown_remaining = std::max(0.0f, cooldown_remaining - delta_time);
+    }
+}
+
+float TeamComposureMode::getMitigationFactor() const {
+    if (!is_active) {
+        return 0.0f;
+    }
+    // a strong leader makes the mode a little more effective
+    const float bonus = activating_coach != nullptr ? activating_coach->getLeadershipBonus() : 0.0f;
+    return std::min(1.0f, effectiveness * (1.0f + bonus));
+}
+
+float TeamComposureMode::getRemainingTime() const {
+    return remaining_time;
+}
+
+float TeamComposureMode::getCooldownRemaining() const {
+    return cooldown_remaining;
+}
+
+bool TeamComposureMode::canActivate() const {
+    return !is_active && cooldown_remaining <= 0.0f;
+}
+
+void TeamComposureMode::setDuration(float newDuration) {
+    duration = newDuration;
+}
+
+void TeamComposureMode::setEffectiveness(float newEffectiveness) {
+    effectiveness = std::min(1.0f, std::max(0.0f, newEffectiveness));
+}
+
+void TeamComposureMode::setCooldownTime(float cooldown) {
+    cooldown_time = cooldown;
+}
@@ -0,0 +1,160 @@
+#ifndef TIERED_INVENTORY_H
+#define TIERED_INVENTORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cold_item_store.h"
+#include "inventory.h"
+
+// inventory for very large, mostly idle item sets: recently used stock
+// lines live in a regular Inventory, the rest as compressed records in a
+// ColdItemStore.
+//
+// sales and restocks go to the hot tier. a sale of a cold item first moves
+// it back to the hot tier, so only the first sale after a quiet spell pays
+// for decoding a block. a name in neither tier is mostly turned away by the
+// two tiers' name filters without decoding anything. when the hot tier
+// outgrows its capacity, the least recently used quarter of it moves to the
+// cold tier in one batch. the hot tier's views (digest, price and quantity
+// indexes, low-stock set) cover hot items only; sales history and reorder
+// points are kept by name, so a promoted item picks them up again.
+class TieredInventory {
+private:
+    using AccessMap = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                         TaggedAllocator<std::pair<const uint64_t, uint64_t>,
+                                                         MemoryTag::INVENTORY_ITEMS>>;
+
+    Inventory hot;
+    ColdItemStore cold;
+    size_t hot_capacity;
+    uint64_t access_clock;
+    AccessMap last_access;      // hot item id -> access_clock at last use
+
+    void touch(size_t item_index) {
+        last_access[hot.get_items()[item_index].get_id()] = ++access_clock;
+    }
+
+    // brings a cold stock line back into the hot tier, at the end of the
+    // hot item list
+    size_t promote(const std::string &name) {
+        ColdRecord record;
+        if (!cold.take(name, &record)) {
+            return Inventory::npos;
+        }
+        hot.add_item(std::move(record.name), record.quantity, record.price);
+        return hot.item_count() - 1;
+    }
+
+    void demote_idle() {
+        const auto &items = hot.get_items();
+        std::vector<std::pair<uint64_t, size_t>> by_age;     // last access, item index
+        by_age.reserve(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            // reserved stock stays hot until its reservation ends
+            if (items[i].get_reserved() == 0) {
+                by_age.emplace_back(last_access[items[i].get_id()], i);
+            }
+        }
+        size_t count = std::min(by_age.size(), items.size() - hot_capacity * 3 / 4);
+        std::nth_element(by_age.begin(), by_age.begin() + static_cast<long>(count), by_age.end());
+        by_age.resize(count);
+
+        // highest index first, so extraction does not shift the rest
+        std::sort(by_age.begin(), by_age.end(),
+                  [](const std::pair<uint64_t, size_t> &a, const std::pair<uint64_t, size_t> &b) {
+                      return a.second > b.second;
+                  });
+        std::vector<ColdRecord> records;
+        records.reserve(count);
+        for (const auto &entry : by_age) {
+            Item item("", 0, 0);
+            hot.extract_at(entry.second, &item);
+            last_access.erase(item.get_id());
+            records.push_back(ColdRecord{item.get_name(), item.get_quantity(), item.get_price()});
+        }
+        cold.insert(std::move(records));
+    }
+
+    void fit_hot_tier() {
+        if (hot.item_count() > hot_capacity) {
+            demote_idle();
+        }
+    }
+
+public:
+    explicit TieredInventory(size_t hot_capacity) :
+            hot{},
+            cold{},
+            hot_capacity{std::max<size_t>(1, hot_capacity)},
+            access_clock{0},
+            last_access{} {
+
+    }
+
+    bool add_item(std::string name, int quantity, float price) {
+        if (!hot.add_item(std::move(name), quantity, price)) {
+            return false;
+        }
+        touch(hot.item_count() - 1);
+        fit_hot_tier();
+        return true;
+    }
+
+    SaleStatus sell(const std::string &name, int quantity, float *money_earned = nullptr) {
+        size_t item_index = hot.find_item(name);
+        if (item_index == Inventory::npos) {
+            item_index = promote(name);
+            if (item_index == Inventory::npos) {
+                return SaleStatus::NOT_FOUND;
+            }
+        }
+        uint64_t id = hot.get_items()[item_index].get_id();
+        SaleStatus status = hot.sell_at(item_index, quantity, money_earned);
+        if (status == SaleStatus::SOLD_OUT) {
+            last_access.erase(id);
+        } else {
+            last_access[id] = ++access_clock;
+            fit_hot_tier();
+        }
+        return status;
+    }
+
+    // stock of the first line with this name in either tier, 0 if none;
+    // looking does not promote
+    int get_quantity(const std::string &name) const {
+        size_t item_index = hot.find_item(name);
+        if (item_index != Inventory::npos) {
+            return hot.get_items()[item_index].get_quantity();
+        }
+        ColdRecord record;
+        return cold.find(name, &record) ? record.quantity : 0;
+    }
+
+    const Inventory &get_hot_tier() const {
+        return hot;
+    }
+
+    size_t hot_count() const {
+        return hot.item_count();
+    }
+
+    size_t cold_count() const {
+        return cold.size();
+    }
+
+    size_t item_count() const {
+        return hot.item_count() + cold.size();
+    }
+
+    float get_total_money() const {
+        return hot.get_total_money();
+    }
+};
+
+#endif
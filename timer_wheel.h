@@ -0,0 +1,90 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "memory_accounting.h"
+
+// hashed timer wheel: one bucket per tick, indexed by expiry tick modulo the
+// wheel size. scheduling is O(1) and advancing the clock only visits the
+// buckets of the ticks that went by, so the cost is per expiry, not per
+// pending timer. timers further out than one revolution stay in their bucket
+// and are skipped until the revolution that reaches them. cancelled timers
+// are not removed here: the owner ignores ids it no longer knows when they
+// come due.
+class TimerWheel {
+private:
+    struct Timer {
+        uint64_t id;
+        uint64_t expires_at;
+    };
+
+    TaggedVector<TaggedVector<Timer, MemoryTag::INVENTORY_ITEMS>, MemoryTag::INVENTORY_ITEMS> buckets;
+    uint64_t tick_ms;
+    uint64_t current_tick;
+    size_t pending;
+
+public:
+    TimerWheel(
+            size_t bucket_count,
+            uint64_t tick_ms
+    ) :
+            buckets(bucket_count),
+            tick_ms{tick_ms},
+            current_tick{0},
+            pending{0} {
+
+    }
+
+    // sets the wheel's time without visiting any bucket, so it can follow a
+    // clock that does not start at zero
+    void start(uint64_t now_ms) {
+        current_tick = now_ms / tick_ms;
+    }
+
+    // expires_at must be after the time of the last advance
+    void schedule(uint64_t id, uint64_t expires_at) {
+        // rounded up, so a bucket only holds timers due by the time it is visited
+        uint64_t tick = (expires_at + tick_ms - 1) / tick_ms;
+        buckets[tick % buckets.size()].push_back({id, expires_at});
+        pending++;
+    }
+
+    // calls on_due(id) for every timer due at now_ms
+    template<typename OnDue>
+    void advance(uint64_t now_ms, OnDue &&on_due) {
+        uint64_t now_tick = now_ms / tick_ms;
+        if (now_tick <= current_tick) {
+            return;
+        }
+        // a jump of a full revolution or more visits every bucket once
+        uint64_t ticks = now_tick - current_tick;
+        if (ticks > buckets.size()) {
+            ticks = buckets.size();
+        }
+        for (uint64_t t = now_tick - ticks + 1; t <= now_tick; t++) {
+            auto &bucket = buckets[t % buckets.size()];
+            for (size_t i = 0; i < bucket.size();) {
+                if (bucket[i].expires_at <= now_ms) {
+                    uint64_t id = bucket[i].id;
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                    pending--;
+                    on_due(id);
+                } else {
+                    i++;
+                }
+            }
+        }
+        current_tick = now_tick;
+    }
+
+    // timers scheduled and not yet due, cancelled ones included
+    size_t pending_count() const {
+        return pending;
+    }
+};
+
+#endif
@@ -0,0 +1,133 @@
+// replay check for EventSourcedInventory.
+//
+// stocks items and then sells at random, so lines sell out and positions
+// shift, copying the live Inventory at a few checkpoints along the way.
+// every checkpoint, and the final sequence, must rebuild through state_at
+// into exactly the copied stock lines and total_money, both while segments
+// are still being compacted and after. then history is discarded up to the
+// middle checkpoint: older states and events must be reported as gone, and
+// the events kept must still run contiguously up to the last one.
+//
+// usage: event_replay_check [seed] [items] [sales] [checkpoints]
+// exit status: 0 every rebuild matched, 1 otherwise
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "event_sourced_inventory.h"
+#include "inventory.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+InventoryState copyLive(const EventSourcedInventory& history) {
+    InventoryState state;
+    state.sequence = history.last_sequence();
+    state.total_money = history.get_inventory().get_total_money();
+    for (const Item& item : history.get_inventory().get_items()) {
+        state.items.push_back(StockLine{item.get_name(), item.get_quantity(), item.get_price()});
+    }
+    return state;
+}
+
+bool sameState(const InventoryState& a, const InventoryState& b) {
+    if (a.sequence != b.sequence || a.total_money != b.total_money || a.items.size() != b.items.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.items.size(); i++) {
+        if (a.items[i].name != b.items[i].name || a.items[i].quantity != b.items[i].quantity ||
+            a.items[i].price != b.items[i].price) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// rebuilds every expected state and reports the slowest rebuild
+int checkRebuilds(const EventSourcedInventory& history, const std::vector<InventoryState>& expected,
+                  const char* when) {
+    int failures = 0;
+    double worst_ms = 0;
+    for (const InventoryState& reference : expected) {
+        InventoryState rebuilt;
+        const auto start = Clock::now();
+        const bool found = history.state_at(reference.sequence, &rebuilt);
+        worst_ms = std::max(worst_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        if (!found || !sameState(rebuilt, reference)) {
+            std::printf("FAILED %s: state_at(%llu) does not match the live inventory\n", when,
+                        static_cast<unsigned long long>(reference.sequence));
+            failures++;
+        }
+    }
+    std::printf("%s: %zu states rebuilt, slowest %.2f ms\n", when, expected.size(), worst_ms);
+    return failures;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1u;
+    const int items = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100000;
+    const int sales = argc > 3 ? std::max(0, std::atoi(argv[3])) : 100000;
+    const int checkpoints = argc > 4 ? std::max(1, std::atoi(argv[4])) : 8;
+
+    std::mt19937 rng(seed);
+    EventSourcedInventory history;
+    std::vector<InventoryState> expected;
+    const int operations = items + sales;
+    const int every = std::max(1, operations / checkpoints);
+
+    for (int i = 0; i < operations; i++) {
+        if (i < items) {
+            history.add_item("sku-" + std::to_string(i), static_cast<int>(rng() % 8) + 1,
+                             static_cast<float>(rng() % 5000) / 100.0f);
+        } else {
+            const std::string name = "sku-" + std::to_string(rng() % static_cast<unsigned>(items));
+            history.sell(name, static_cast<int>(rng() % 3) + 1);
+        }
+        if ((i + 1) % every == 0) {
+            expected.push_back(copyLive(history));
+        }
+    }
+    expected.push_back(copyLive(history));
+    std::printf("seed %u, %d items, %d sales, %llu events, %zu live lines\n", seed, items, sales,
+                static_cast<unsigned long long>(history.last_sequence()), history.get_inventory().item_count());
+
+    int failures = checkRebuilds(history, expected, "while compacting");
+    history.wait_for_compaction();
+    failures += checkRebuilds(history, expected, "compacted");
+    std::printf("%zu snapshots, %zu bytes of history\n", history.snapshot_count(), history.history_bytes());
+
+    // discard up to the middle checkpoint
+    const std::size_t middle = expected.size() / 2;
+    history.discard_before(expected[middle].sequence);
+    const uint64_t kept = history.first_retained_sequence();
+    std::vector<InventoryEvent> events;
+    InventoryState gone;
+    if (expected.front().sequence < kept &&
+        (history.state_at(expected.front().sequence, &gone) || history.get_events(1, kept, &events))) {
+        std::printf("FAILED: discarded history is still reported as available\n");
+        failures++;
+    }
+    if (!history.get_events(kept, history.last_sequence(), &events) || events.empty() ||
+        events.front().sequence != kept || events.back().sequence != history.last_sequence() ||
+        events.size() != history.last_sequence() - kept + 1) {
+        std::printf("FAILED: retained events %llu.. are not contiguous\n", static_cast<unsigned long long>(kept));
+        failures++;
+    }
+    if (history.get_events(kept, history.last_sequence() + 1, &events)) {
+        std::printf("FAILED: events past the last sequence are reported as available\n");
+        failures++;
+    }
+    failures += checkRebuilds(history, std::vector<InventoryState>(expected.begin() + static_cast<long>(middle),
+                                                                   expected.end()),
+                              "after discarding");
+    std::printf("history kept from event %llu\n", static_cast<unsigned long long>(kept));
+    return failures == 0 ? 0 : 1;
+}
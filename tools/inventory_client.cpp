@@ -0,0 +1,251 @@
+// local client harness for the inventory daemon.
+//
+// drives a daemon with a random stream of adds, sales and lookups, keeping
+// up to pipeline_depth requests in flight, and checks every response
+// against a local Inventory that applies the same stream directly. with
+// socket "-" (the default) it runs the daemon in-process on the other end of
+// a socketpair; otherwise it connects to a fresh `inventory --serve <socket>`.
+// reports throughput, per-request latency and, in-process, how many
+// requests the daemon ran per batch.
+//
+// usage: inventory_client [socket|-] [requests] [pipeline_depth] [seed]
+// exit status: 0 all responses match, 1 a response differs, 2 I/O failure
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "inventory_daemon.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct InFlight {
+    ServiceResponse expected;
+    Clock::time_point sent;
+};
+
+int connectTo(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool writeAll(int fd, const std::vector<uint8_t>& bytes) {
+    std::size_t done = 0;
+    while (done < bytes.size()) {
+        const ssize_t wrote = write(fd, bytes.data() + done, bytes.size() - done);
+        if (wrote < 0) {
+            return false;
+        }
+        done += static_cast<std::size_t>(wrote);
+    }
+    return true;
+}
+
+class ClientHarness {
+private:
+    std::mt19937 rng;
+    Inventory model;
+    int names;
+    uint32_t next_id = 1;
+
+    std::string pickName() {
+        return "sku-" + std::to_string(std::uniform_int_distribution<int>(0, names - 1)(rng));
+    }
+
+    // the next request, and the response the model says it must get
+    ServiceRequest nextRequest(ServiceResponse* expected) {
+        ServiceRequest request{next_id++, ServiceOp::SELL, 0, 0, pickName()};
+        const unsigned roll = rng() % 100;
+        if (request.id <= static_cast<uint32_t>(names) || roll < 12) {
+            request.op = ServiceOp::ADD_ITEM;
+            request.quantity = static_cast<int>(rng() % 30);      // 0 is rejected
+            request.price = 0.5f + static_cast<float>(rng() % 400) / 4.0f;
+        } else if (roll < 75) {
+            request.quantity = static_cast<int>(rng() % 4);       // 0 is rejected
+        } else if (roll < 97) {
+            request.op = ServiceOp::GET_ITEM;
+        } else {
+            request.op = ServiceOp::GET_TOTALS;
+            request.name.clear();
+        }
+
+        *expected = ServiceResponse{request.id, ServiceStatus::OK, request.op, 0, 0};
+        switch (request.op) {
+            case ServiceOp::ADD_ITEM:
+                if (!model.add_item(request.name, request.quantity, request.price)) {
+                    expected->status = ServiceStatus::INVALID_QUANTITY;
+                }
+                expected->first = static_cast<uint32_t>(model.item_count());
+                break;
+            case ServiceOp::SELL: {
+                const std::size_t index = model.find_item(request.name);
+                if (index == Inventory::npos) {
+                    expected->status = ServiceStatus::NOT_FOUND;
+                    break;
+                }
+                float earned = 0;
+                const SaleStatus status = model.sell_at(index, request.quantity, &earned);
+                expected->status = ServiceProtocol::status_of(status);
+                expected->first = ServiceProtocol::float_bits(earned);
+                expected->second = static_cast<uint32_t>(
+                        status == SaleStatus::SOLD_OUT ? 0 : model.get_items()[index].get_quantity());
+                break;
+            }
+            case ServiceOp::GET_ITEM: {
+                const std::size_t index = model.find_item(request.name);
+                if (index == Inventory::npos) {
+                    expected->status = ServiceStatus::NOT_FOUND;
+                    break;
+                }
+                expected->first = static_cast<uint32_t>(model.get_items()[index].get_quantity());
+                expected->second = ServiceProtocol::float_bits(model.get_items()[index].get_price());
+                break;
+            }
+            case ServiceOp::GET_TOTALS:
+                expected->first = ServiceProtocol::float_bits(model.get_total_money());
+                expected->second = static_cast<uint32_t>(model.item_count());
+                break;
+        }
+        return request;
+    }
+
+public:
+    ClientHarness(unsigned seed, int nameCount)
+        : rng(seed),
+          names(nameCount) {
+    }
+
+    int run(int fd, int requests, int depth) {
+        std::deque<InFlight> inFlight;
+        std::vector<double> latencies;
+        latencies.reserve(static_cast<std::size_t>(requests));
+        std::vector<uint8_t> outgoing;
+        std::vector<uint8_t> incoming;
+        std::size_t parsed = 0;
+        int sent = 0;
+        long mismatches = 0;
+
+        const Clock::time_point start = Clock::now();
+        while (sent < requests || !inFlight.empty()) {
+            outgoing.clear();
+            while (sent < requests && static_cast<int>(inFlight.size()) < depth) {
+                InFlight entry;
+                ServiceProtocol::append_request(outgoing, nextRequest(&entry.expected));
+                entry.sent = Clock::now();
+                inFlight.push_back(entry);
+                sent++;
+            }
+            if (!outgoing.empty() && !writeAll(fd, outgoing)) {
+                std::printf("write failed: %s\n", std::strerror(errno));
+                return 2;
+            }
+
+            uint8_t chunk[64 * 1024];
+            const ssize_t got = read(fd, chunk, sizeof(chunk));
+            if (got <= 0) {
+                std::printf("daemon closed the connection with %zu requests in flight\n", inFlight.size());
+                return 2;
+            }
+            incoming.insert(incoming.end(), chunk, chunk + got);
+            ServiceResponse response;
+            while (ServiceProtocol::parse_response(incoming.data() + parsed, incoming.size() - parsed, &response)) {
+                parsed += ServiceProtocol::kResponseBytes;
+                const InFlight& entry = inFlight.front();
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - entry.sent).count());
+                const ServiceResponse& want = entry.expected;
+                if (response.id != want.id || response.status != want.status || response.op != want.op ||
+                    response.first != want.first || response.second != want.second) {
+                    if (mismatches < 5) {
+                        std::printf("  MISMATCH: request %u op %d: status %d (want %d), fields %08x %08x "
+                                    "(want %08x %08x)\n",
+                                    want.id, static_cast<int>(want.op), static_cast<int>(response.status),
+                                    static_cast<int>(want.status), response.first, response.second, want.first,
+                                    want.second);
+                    }
+                    mismatches++;
+                }
+                inFlight.pop_front();
+            }
+            incoming.erase(incoming.begin(), incoming.begin() + static_cast<long>(parsed));
+            parsed = 0;
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) {
+            return latencies.empty() ? 0.0 : latencies[static_cast<std::size_t>(p * (latencies.size() - 1))];
+        };
+        std::printf("%d requests in %.3f s: %.0f requests/s\n", requests, seconds, requests / seconds);
+        std::printf("latency us: p50 %.1f  p99 %.1f  max %.1f\n", percentile(0.5), percentile(0.99),
+                    percentile(1.0));
+        std::printf("%zu stock lines, total money %.2f\n", model.item_count(), model.get_total_money());
+        std::printf("%ld mismatched responses\n", mismatches);
+        return mismatches == 0 ? 0 : 1;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string socketPath = argc > 1 ? argv[1] : "-";
+    const int requests = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200000;
+    const int depth = argc > 3 ? std::max(1, std::atoi(argv[3])) : 64;
+    const unsigned seed = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 1u;
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::printf("%s, %d requests, pipeline depth %d, seed %u\n",
+                socketPath == "-" ? "in-process daemon" : socketPath.c_str(), requests, depth, seed);
+    ClientHarness harness(seed, 2000);
+    if (socketPath != "-") {
+        const int fd = connectTo(socketPath);
+        if (fd < 0) {
+            std::printf("cannot connect to %s: %s\n", socketPath.c_str(), std::strerror(errno));
+            return 2;
+        }
+        const int status = harness.run(fd, requests, depth);
+        close(fd);
+        return status;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::printf("socketpair failed: %s\n", std::strerror(errno));
+        return 2;
+    }
+    InventoryDaemon daemon;
+    daemon.add_connection(fds[1], fds[1]);
+    std::thread server([&daemon] { daemon.run(); });
+    const int status = harness.run(fds[0], requests, depth);
+    close(fds[0]);
+    server.join();
+    std::printf("daemon ran %llu requests in %llu batches (%.1f per batch)\n",
+                static_cast<unsigned long long>(daemon.request_count()),
+                static_cast<unsigned long long>(daemon.batch_count()),
+                daemon.batch_count() == 0 ? 0.0
+                                          : static_cast<double>(daemon.request_count()) / daemon.batch_count());
+    return status;
+}
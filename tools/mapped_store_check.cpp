@@ -0,0 +1,223 @@
+// consistency and lookup check for MappedItemStore, which stands alone: it
+// is not the storage behind Inventory.
+//
+// runs one operation stream against a store and an Inventory and requires
+// the same sale statuses and the same stock, before and after reopening.
+// then kills a child process part way through a stream of sales, over and
+// over, and requires every reopened store to balance: the money taken must
+// equal the stock that left at its price. durable mode is used for every
+// other round. last, times find_item on the full store.
+//
+// usage: mapped_store_check [seed] [items] [crash_rounds]
+// exit status: 0 every check passed, 1 otherwise
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "inventory.h"
+#include "mapped_item_store.h"
+
+namespace {
+
+struct StockLine {
+    std::string name;
+    int quantity;
+    float price;
+};
+
+std::vector<StockLine> makeLines(std::mt19937& rng, int items) {
+    std::vector<StockLine> lines;
+    for (int i = 0; i < items; i++) {
+        // whole prices and small quantities keep every money total exact
+        lines.push_back({"sku-" + std::to_string(i), static_cast<int>(rng() % 50) + 1,
+                         static_cast<float>(rng() % 20 + 1)});
+    }
+    return lines;
+}
+
+void removeStore(const std::string& path) {
+    unlink(path.c_str());
+    unlink((path + ".names").c_str());
+}
+
+int compareStock(const MappedItemStore& store, const Inventory& inventory, const char* when) {
+    int failures = 0;
+    if (store.item_count() != inventory.item_count() || store.get_total_money() != inventory.get_total_money()) {
+        std::printf("FAILED %s: %zu items / %.2f money, inventory has %zu / %.2f\n", when, store.item_count(),
+                    store.get_total_money(), inventory.item_count(), inventory.get_total_money());
+        failures++;
+    }
+    for (const Item& item : inventory.get_items()) {
+        const uint32_t slot = store.find_item(item.get_name());
+        if (slot == MappedItemStore::npos || store.get_quantity(slot) != item.get_quantity() ||
+            store.get_price(slot) != item.get_price()) {
+            std::printf("FAILED %s: %s differs\n", when, item.get_name().c_str());
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// the same adds and sales on both, with re-adds of sold-out names so slots
+// and heap space are reused
+int checkParity(const std::string& path, std::mt19937& rng, int items) {
+    removeStore(path);
+    MappedItemStore store;
+    if (!store.open(path)) {
+        std::printf("FAILED: cannot open %s\n", path.c_str());
+        return 1;
+    }
+    Inventory inventory;
+    const std::vector<StockLine> lines = makeLines(rng, items);
+    for (const StockLine& line : lines) {
+        store.add_item(line.name, line.quantity, line.price);
+        inventory.add_item(line.name, line.quantity, line.price);
+    }
+
+    int failures = 0;
+    int mismatches = 0;
+    const int operations = items * 4;
+    for (int i = 0; i < operations; i++) {
+        const StockLine& line = lines[rng() % lines.size()];
+        if (rng() % 8 == 0) {
+            if (inventory.find_item(line.name) == Inventory::npos) {
+                store.add_item(line.name, line.quantity, line.price);
+                inventory.add_item(line.name, line.quantity, line.price);
+            }
+            continue;
+        }
+        const int quantity = static_cast<int>(rng() % 12) - 1;
+        if (store.sell(line.name, quantity) != inventory.sell(line.name, quantity)) {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        std::printf("FAILED: %d of %d sale statuses differ from Inventory\n", mismatches, operations);
+        failures++;
+    }
+    failures += compareStock(store, inventory, "after the stream");
+    store.close();
+    if (!store.open(path)) {
+        std::printf("FAILED: cannot reopen %s\n", path.c_str());
+        return failures + 1;
+    }
+    failures += compareStock(store, inventory, "after reopening");
+    std::printf("parity: %d operations, %zu items left, %.2f money\n", operations, store.item_count(),
+                store.get_total_money());
+    return failures;
+}
+
+// a child sells until it is killed; the reopened store has to balance
+int checkCrash(const std::string& path, std::mt19937& rng, int items, bool durable, double& money_taken) {
+    removeStore(path);
+    const std::vector<StockLine> lines = makeLines(rng, items);
+    {
+        MappedItemStore store;
+        if (!store.open(path)) {
+            std::printf("FAILED: cannot open %s\n", path.c_str());
+            return 1;
+        }
+        for (const StockLine& line : lines) {
+            store.add_item(line.name, line.quantity, line.price);
+        }
+    }
+
+    const unsigned child_seed = static_cast<unsigned>(rng());
+    const pid_t child = fork();
+    if (child == 0) {
+        MappedItemStore store;
+        if (!store.open(path)) {
+            _exit(1);
+        }
+        store.set_durable(durable);
+        std::mt19937 child_rng(child_seed);
+        for (;;) {
+            store.sell(lines[child_rng() % lines.size()].name, static_cast<int>(child_rng() % 4) + 1);
+        }
+    }
+    usleep(static_cast<useconds_t>(rng() % 20000 + 500));
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+
+    MappedItemStore store;
+    if (!store.open(path)) {
+        std::printf("FAILED: cannot reopen %s after the kill\n", path.c_str());
+        return 1;
+    }
+    float taken = 0;
+    size_t live = 0;
+    for (const StockLine& line : lines) {
+        const uint32_t slot = store.find_item(line.name);
+        const int left = slot == MappedItemStore::npos ? 0 : store.get_quantity(slot);
+        live += slot == MappedItemStore::npos ? 0 : 1;
+        taken += static_cast<float>(line.quantity - left) * line.price;
+    }
+    if (taken != store.get_total_money() || live != store.item_count()) {
+        std::printf("FAILED: killed store holds %.2f money for %.2f of stock taken, %zu items for %zu found\n",
+                    store.get_total_money(), taken, store.item_count(), live);
+        return 1;
+    }
+    money_taken += store.get_total_money();
+    return 0;
+}
+
+void timeLookups(const std::string& path, std::mt19937& rng, int items) {
+    removeStore(path);
+    MappedItemStore store;
+    if (!store.open(path)) {
+        return;
+    }
+    const std::vector<StockLine> lines = makeLines(rng, items);
+    for (const StockLine& line : lines) {
+        store.add_item(line.name, line.quantity, line.price);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    uint32_t found = 0;
+    for (const StockLine& line : lines) {
+        found += store.find_item(line.name) != MappedItemStore::npos ? 1 : 0;
+        found += store.find_item(line.name + "?") != MappedItemStore::npos ? 1 : 0;
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("find_item over %d items: %.1f ns per lookup (%u found)\n", items, ns / (2.0 * items), found);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1u;
+    const int items = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20000;
+    const int rounds = argc > 3 ? std::max(0, std::atoi(argv[3])) : 20;
+
+    char directory[] = "/tmp/mapped_store_XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        std::printf("FAILED: cannot create a scratch directory\n");
+        return 1;
+    }
+    const std::string path = std::string(directory) + "/items";
+    std::mt19937 rng(seed);
+    std::printf("seed %u, %d items, %d crash rounds in %s\n", seed, items, rounds, directory);
+
+    int failures = checkParity(path, rng, items);
+    int crash_failures = 0;
+    double money_taken = 0;
+    for (int round = 0; round < rounds; round++) {
+        crash_failures += checkCrash(path, rng, std::min(items, 1000), round % 2 == 1, money_taken);
+    }
+    std::printf("crash: %d of %d killed stores failed to balance, %.2f money taken in all\n", crash_failures,
+                rounds, money_taken);
+    timeLookups(path, rng, items);
+
+    removeStore(path);
+    rmdir(directory);
+    return failures + crash_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// primary / standby reconciliation check for the inventory merkle digest.
+//
+// builds two in-process Inventory replicas from the same operation stream,
+// checks their digests agree, then lets the standby miss a few operations
+// and drift on its own. the replicas are compared the way two servers
+// would: walking down from the root through differing digest nodes only,
+// then comparing the stock lines of the differing buckets. the names found
+// that way must be exactly the names whose stock really differs.
+//
+// usage: replica_reconcile [seed] [items] [divergent_operations]
+// exit status: 0 when the diff finds exactly the differing items, 1 otherwise
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "inventory.h"
+
+namespace {
+
+using StockLine = std::tuple<std::string, int, float>;
+
+// what a replica would send for one bucket
+std::vector<StockLine> bucketLines(const Inventory& inventory, std::size_t bucket) {
+    std::vector<StockLine> lines;
+    for (const Item* item : inventory.get_items_in_bucket(bucket)) {
+        lines.emplace_back(item->get_name(), item->get_quantity(), item->get_price());
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+// names whose stock lines differ, from a full comparison of both replicas
+std::set<std::string> differingNames(const Inventory& primary, const Inventory& standby) {
+    std::map<std::string, std::multiset<std::pair<int, float>>> lines[2];
+    const Inventory* replicas[2] = {&primary, &standby};
+    for (int r = 0; r < 2; r++) {
+        for (const Item& item : replicas[r]->get_items()) {
+            lines[r][item.get_name()].emplace(item.get_quantity(), item.get_price());
+        }
+    }
+    std::set<std::string> names;
+    for (int r = 0; r < 2; r++) {
+        for (const auto& entry : lines[r]) {
+            auto other = lines[1 - r].find(entry.first);
+            if (other == lines[1 - r].end() || other->second != entry.second) {
+                names.insert(entry.first);
+            }
+        }
+    }
+    return names;
+}
+
+class ReplicaPair {
+private:
+    std::mt19937 rng;
+    Inventory primary;
+    Inventory standby;
+    int item_count;
+
+    std::string pickName() {
+        return "sku-" + std::to_string(std::uniform_int_distribution<int>(0, item_count - 1)(rng));
+    }
+
+    // a sale or, now and then, a restock
+    void randomOperation(Inventory& inventory) {
+        if (rng() % 8 == 0) {
+            inventory.add_item(pickName(), static_cast<int>(rng() % 20) + 1, 4.5f);
+        } else {
+            inventory.sell(pickName(), static_cast<int>(rng() % 3) + 1);
+        }
+    }
+
+public:
+    ReplicaPair(unsigned seed, int items)
+        : rng(seed),
+          item_count(items) {
+    }
+
+    void replicate(int operations) {
+        for (int i = 0; i < item_count; i++) {
+            const std::string name = "sku-" + std::to_string(i);
+            const int quantity = static_cast<int>(rng() % 50) + 1;
+            const float price = 1.0f + static_cast<float>(rng() % 100);
+            primary.add_item(name, quantity, price);
+            standby.add_item(name, quantity, price);
+        }
+        for (int i = 0; i < operations; i++) {
+            // same stream on both: replay the generator for the standby
+            const std::mt19937 state = rng;
+            randomOperation(primary);
+            rng = state;
+            randomOperation(standby);
+        }
+    }
+
+    // the standby misses some operations and applies some of its own
+    void diverge(int operations) {
+        for (int i = 0; i < operations; i++) {
+            randomOperation(i % 2 == 0 ? primary : standby);
+        }
+    }
+
+    int check() const {
+        std::size_t hashes = 0;
+        const std::vector<std::size_t> buckets = primary.get_digest().diff(standby.get_digest(), &hashes);
+
+        std::set<std::string> found;
+        for (std::size_t bucket : buckets) {
+            const std::vector<StockLine> mine = bucketLines(primary, bucket);
+            const std::vector<StockLine> theirs = bucketLines(standby, bucket);
+            std::vector<StockLine> changed;
+            std::set_symmetric_difference(mine.begin(), mine.end(), theirs.begin(), theirs.end(),
+                                          std::back_inserter(changed));
+            for (const StockLine& line : changed) {
+                found.insert(std::get<0>(line));
+            }
+        }
+        const std::set<std::string> expected = differingNames(primary, standby);
+
+        std::printf("%zu + %zu stock lines, roots %016llx / %016llx\n", primary.item_count(),
+                    standby.item_count(), static_cast<unsigned long long>(primary.get_digest().root()),
+                    static_cast<unsigned long long>(standby.get_digest().root()));
+        std::printf("%zu differing buckets found with %zu node hashes (of %zu)\n", buckets.size(), hashes,
+                    InventoryDigest::node_count() - 1);
+        std::printf("%zu differing items found, %zu expected\n", found.size(), expected.size());
+        if (found != expected) {
+            std::printf("FAILED: digest diff disagrees with a full comparison\n");
+            return 1;
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1u;
+    const int items = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10000;
+    const int divergent = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    std::printf("seed %u, %d items, %d divergent operations\n", seed, items, divergent);
+    ReplicaPair replicas(seed, items);
+    replicas.replicate(items * 4);
+    std::printf("in sync:\n");
+    int status = replicas.check();
+    replicas.diverge(divergent);
+    std::printf("after divergence:\n");
+    status |= replicas.check();
+    return status;
+}
@@ -0,0 +1,471 @@
+// randomized stress harness for CrowdMomentumSystem and Inventory.
+//
+// drives both with adversarial operation sequences (event storms, odd time
+// steps, piles of effects on one player, thousands of crowd sections,
+// inventories full of duplicate names, nonsense quantities), checks the
+// invariants after every operation and times each one against a budget.
+// budget overruns are reported but depend on the host, so they only fail
+// the run with --strict.
+//
+// ConcurrentInventory runs the same kind of stream next to an Inventory,
+// which must give the same statuses and stock (a bundle whose repeated lines
+// overflow int must fail whole in both), then takes bundles from
+// several checkout threads at once while restocks arrive. afterwards every
+// item must hold its stock plus restocks minus sales, and the money must
+// match what the sales reported. bundle throughput is printed for one
+// thread and for several over disjoint items.
+//
+// usage: stress_harness [--strict] [seed] [operations] [budget_us]
+// exit status: 0 no invariant violated, 1 invariant violated,
+//              2 (--strict only) latency budget exceeded
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_inventory.h"
+#include "crowd_momentum_system.h"
+#include "inventory.h"
+#include "memory_accounting.h"
+#include "simulated_game.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Op {
+    OP_EVENT_STORM,
+    OP_UPDATE,
+    OP_PILE_EFFECT,
+    OP_DROP_EFFECT,
+    OP_ADD_SECTIONS,
+    OP_SPREAD,
+    OP_CONFIGURE,
+    OP_QUERY,
+    OP_ADD_ITEM,
+    OP_SELL_ITEM,
+    OP_SELL_MISSING,
+    OP_SELL_BUNDLE,
+    OP_COUNT
+};
+
+const char* const kOpNames[OP_COUNT] = {
+    "event_storm", "update", "pile_effect", "drop_effect", "add_sections", "spread",
+    "configure", "query", "add_item", "sell_item", "sell_missing", "sell_bundle"
+};
+
+struct OpStats {
+    long count = 0;
+    long over_budget = 0;
+    double worst_us = 0.0;
+    std::size_t worst_size = 0;
+};
+
+class StressHarness {
+private:
+    std::mt19937 rng;
+    double budget_us;
+    OpStats stats[OP_COUNT];
+    std::vector<std::string> failures;
+    long checks = 0;
+
+    template <typename F>
+    void timed(Op op, std::size_t size, F&& operation) {
+        auto start = Clock::now();
+        operation();
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        OpStats& s = stats[op];
+        s.count++;
+        if (us > budget_us) {
+            s.over_budget++;
+        }
+        if (us > s.worst_us) {
+            s.worst_us = us;
+            s.worst_size = size;
+        }
+    }
+
+    void expect(bool condition, const char* invariant, double value) {
+        checks++;
+        if (!condition && failures.size() < 50) {
+            std::ostringstream out;
+            out << invariant << " (value " << value << ")";
+            failures.push_back(out.str());
+        }
+    }
+
+    float uniform(float lo, float hi) {
+        return std::uniform_real_distribution<float>(lo, hi)(rng);
+    }
+
+    int uniformInt(int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    }
+
+    void checkMomentum(SimulatedGame& game, const Player& target) {
+        const MomentumMeter& meter = *game.system.getMomentumMeter();
+        for (const Team* team : {&game.home, &game.away}) {
+            const float m = meter.getMomentum(*team);
+            expect(std::isfinite(m), "momentum is finite", m);
+            expect(m >= 0.0f && m <= 100.0f, "momentum within min_momentum..max_momentum", m);
+            expect(meter.getMomentumLevel(*team) == meter.getLevelClassifier().classify(m),
+                   "cached MomentumLevel matches classification", m);
+        }
+
+        const Crowd& crowd = *game.stadium.getCrowd();
+        expect(std::isfinite(crowd.getNoiseLevel()), "crowd noise is finite", crowd.getNoiseLevel());
+        expect(crowd.getVolumeLevel() >= 0.0f && crowd.getVolumeLevel() <= 1.0f,
+               "crowd volume within 0..1", crowd.getVolumeLevel());
+        expect(crowd.getEnthusiasm() >= 0.0f && crowd.getEnthusiasm() <= 100.0f,
+               "crowd enthusiasm within 0..100", crowd.getEnthusiasm());
+
+        const PlayerStats s = target.getModifiedStats();
+        for (float stat : {s.speed, s.accuracy, s.strength, s.awareness, s.composure}) {
+            expect(std::isfinite(stat) && stat >= 0.0f, "player stats finite and non-negative", stat);
+        }
+    }
+
+    void checkInventory(const Inventory& inventory, float previous_money) {
+        for (const Item& item : inventory.get_items()) {
+            expect(item.get_quantity() > 0, "item quantity positive (no ghost or negative entries)",
+                   item.get_quantity());
+        }
+        const std::vector<const Item*> by_quantity = inventory.get_items_by_quantity();
+        expect(by_quantity.size() == inventory.item_count(), "quantity index covers every item",
+               static_cast<double>(by_quantity.size()));
+        expect(std::is_sorted(by_quantity.begin(), by_quantity.end(),
+                              [](const Item* a, const Item* b) { return a->get_quantity() < b->get_quantity(); }),
+               "quantity index in quantity order", 0);
+        const float money = inventory.get_total_money();
+        expect(std::isfinite(money), "total money finite", money);
+        expect(money >= previous_money, "total money never decreases", money - previous_money);
+    }
+
+public:
+    StressHarness(unsigned seed, double budgetUs)
+        : rng(seed),
+          budget_us(budgetUs) {
+    }
+
+    void runMomentum(int operations) {
+        SimulatedGame game(20000);
+        Player& target = *game.home.getPlayers()[0];
+        Crowd& crowd = *game.stadium.getCrowd();
+        std::vector<std::unique_ptr<MomentumEffect>> piled;
+
+        std::vector<ModifierQuery> queries;
+        for (const Team* team : {&game.home, &game.away}) {
+            for (const Player* player : team->getPlayers()) {
+                for (std::size_t e = 0; e < kEffectTypeCount; e++) {
+                    queries.push_back(game.system.makeModifierQuery(*player, static_cast<EffectType>(e)));
+                }
+            }
+        }
+        std::vector<float> modifiers;
+
+        static const float kSteps[] = {0.0f, -1.0f, 1.0f / 30.0f, 0.5f, 5.0f, 1e-6f};
+
+        for (int i = 0; i < operations; i++) {
+            const int roll = uniformInt(0, 99);
+            if (roll < 30) {
+                const int events = uniformInt(1, 50);
+                timed(OP_EVENT_STORM, events, [&] {
+                    for (int e = 0; e < events; e++) {
+                        game.playRandomEvent(rng);
+                    }
+                });
+            } else if (roll < 45) {
+                const float step = kSteps[uniformInt(0, 5)];
+                timed(OP_UPDATE, 1, [&] { game.system.updateMomentum(step); });
+            } else if (roll < 60) {
+                const auto type = static_cast<EffectType>(uniformInt(0, static_cast<int>(kEffectTypeCount) - 1));
+                piled.push_back(std::make_unique<MomentumEffect>(type, uniform(-1.0f, 3.0f),
+                                                                 uniform(-5.0f, 60.0f), &game.home));
+                timed(OP_PILE_EFFECT, piled.size(), [&] { piled.back()->apply(target); });
+            } else if (roll < 65) {
+                if (!piled.empty()) {
+                    const std::size_t index = static_cast<std::size_t>(uniformInt(0, static_cast<int>(piled.size()) - 1));
+                    timed(OP_DROP_EFFECT, piled.size(), [&] { piled[index]->remove(target); });
+                    piled.erase(piled.begin() + static_cast<long>(index));
+                }
+            } else if (roll < 72) {
+                if (crowd.getSectionCount() < 5000) {
+                    const int sections = uniformInt(1, 200);
+                    timed(OP_ADD_SECTIONS, crowd.getSectionCount(), [&] {
+                        for (int s = 0; s < sections; s++) {
+                            crowd.addCrowdSection((s & 1) != 0 ? &game.home : &game.away, uniformInt(-10, 3000));
+                        }
+                    });
+                }
+            } else if (roll < 80) {
+                const float step = kSteps[uniformInt(0, 5)];
+                timed(OP_SPREAD, crowd.getSectionCount(), [&] {
+                    crowd.spreadEnthusiasm(step);
+                    crowd.generateNoise();
+                });
+            } else if (roll < 88) {
+                timed(OP_CONFIGURE, 1, [&] {
+                    MomentumMeter& meter = *game.system.getMomentumMeter();
+                    meter.setThreshold(uniform(-50.0f, 150.0f));
+                    meter.setDecayRate(uniform(-1.0f, 5.0f));
+                    crowd.updateEnthusiasm(uniform(-500.0f, 500.0f));
+                    crowd.setContagionRate(uniform(-1.0f, 50.0f));
+                    target.setComposureLevel(uniform(-1.0f, 2.0f));
+                    game.home.getCoach()->activateTeamComposure();
+                });
+            } else {
+                timed(OP_QUERY, queries.size(), [&] { game.system.queryModifiers(queries, modifiers); });
+            }
+            checkMomentum(game, target);
+        }
+        target.clearAllEffects();
+    }
+
+    void runInventory(int operations) {
+        Inventory inventory;
+        // a tiny name pool, so the inventory fills up with duplicates
+        std::vector<std::string> names;
+        for (int i = 0; i < 16; i++) {
+            names.push_back("dup-" + std::to_string(i));
+        }
+        static const int kQuantities[] = {-5, 0, 1, 3, 1000, 1 << 30};
+
+        for (int i = 0; i < operations; i++) {
+            const int roll = uniformInt(0, 99);
+            const float previous_money = inventory.get_total_money();
+            const std::string& name = names[static_cast<std::size_t>(uniformInt(0, 15))];
+            if (roll < 45) {
+                const int quantity = kQuantities[uniformInt(0, 5)];
+                const float price = uniform(-10.0f, 100.0f);
+                timed(OP_ADD_ITEM, inventory.item_count(), [&] { inventory.add_item(name, quantity, price); });
+            } else if (roll < 85) {
+                const int quantity = kQuantities[uniformInt(0, 5)];
+                timed(OP_SELL_ITEM, inventory.item_count(), [&] { inventory.sell(name, quantity); });
+            } else {
+                timed(OP_SELL_MISSING, inventory.item_count(), [&] { inventory.sell("missing-" + name, 1); });
+            }
+            checkInventory(inventory, previous_money);
+        }
+    }
+
+    // one Inventory-compatible stream; whole prices keep the money exact
+    void runConcurrentParity(int operations) {
+        ConcurrentInventory shared;
+        Inventory inventory;
+        std::vector<std::string> names;
+        for (int i = 0; i < 64; i++) {
+            names.push_back("line-" + std::to_string(i));
+        }
+        static const int kQuantities[] = {-2, 0, 1, 2, 3, 5, 40};
+
+        long mismatches = 0;
+        for (int i = 0; i < operations; i++) {
+            const int roll = uniformInt(0, 99);
+            const std::string& name = names[static_cast<std::size_t>(uniformInt(0, 63))];
+            if (roll < 20) {
+                // Inventory would add a second line for a stocked name
+                if (inventory.find_item(name) == Inventory::npos) {
+                    const int quantity = uniformInt(1, 40);
+                    const float price = static_cast<float>(uniformInt(1, 9));
+                    shared.add_item(name, quantity, price);
+                    inventory.add_item(name, quantity, price);
+                }
+            } else if (roll < 50) {
+                const int quantity = kQuantities[uniformInt(0, 6)];
+                mismatches += shared.sell(name, quantity) != inventory.sell(name, quantity) ? 1 : 0;
+            } else {
+                std::vector<BundleLine> lines(static_cast<std::size_t>(uniformInt(1, 4)));
+                for (BundleLine& line : lines) {
+                    line.name = uniformInt(0, 9) == 0 ? "missing" : names[static_cast<std::size_t>(uniformInt(0, 63))];
+                    line.quantity = kQuantities[uniformInt(0, 6)];
+                }
+                std::size_t shared_line = 0;
+                std::size_t inventory_line = 0;
+                SaleStatus status = SaleStatus::SOLD;
+                timed(OP_SELL_BUNDLE, lines.size(), [&] { status = shared.sell_bundle(lines, nullptr, &shared_line); });
+                const SaleStatus expected = inventory.sell_bundle(lines, nullptr, &inventory_line);
+                mismatches += status != expected || (status != SaleStatus::SOLD && shared_line != inventory_line) ? 1 : 0;
+            }
+        }
+        // repeated lines whose sum wraps int must fail whole, not sell part
+        const std::vector<BundleLine> wrapping = {{"wrap-b", 1}, {"wrap-a", 1}, {"wrap-a", INT_MAX}};
+        for (const std::string& wrap_name : {std::string("wrap-a"), std::string("wrap-b")}) {
+            shared.add_item(wrap_name, 5, 3);
+            inventory.add_item(wrap_name, 5, 3);
+        }
+        std::size_t shared_line = 0;
+        std::size_t inventory_line = 0;
+        const SaleStatus shared_wrap = shared.sell_bundle(wrapping, nullptr, &shared_line);
+        const SaleStatus inventory_wrap = inventory.sell_bundle(wrapping, nullptr, &inventory_line);
+        expect(shared_wrap == SaleStatus::INSUFFICIENT_QUANTITY && shared_line == 2,
+               "ConcurrentInventory rejects a bundle whose repeated lines overflow", static_cast<double>(shared_line));
+        expect(inventory_wrap == SaleStatus::INSUFFICIENT_QUANTITY && inventory_line == 2,
+               "Inventory rejects a bundle whose repeated lines overflow", static_cast<double>(inventory_line));
+        const std::size_t wrap_index = inventory.find_item("wrap-b");
+        expect(shared.get_quantity("wrap-a") == 5 && shared.get_quantity("wrap-b") == 5,
+               "a rejected bundle leaves ConcurrentInventory untouched", shared.get_quantity("wrap-a"));
+        expect(wrap_index != Inventory::npos && inventory.get_items()[wrap_index].get_quantity() == 5,
+               "a rejected bundle leaves Inventory untouched", static_cast<double>(wrap_index));
+
+        expect(mismatches == 0, "ConcurrentInventory statuses match Inventory", static_cast<double>(mismatches));
+        expect(shared.item_count() == inventory.item_count(), "ConcurrentInventory item count matches Inventory",
+               static_cast<double>(shared.item_count()));
+        expect(shared.get_total_money() == inventory.get_total_money(), "ConcurrentInventory money matches Inventory",
+               shared.get_total_money() - inventory.get_total_money());
+        for (const std::string& name : names) {
+            const std::size_t index = inventory.find_item(name);
+            const int quantity = index == Inventory::npos ? 0 : inventory.get_items()[index].get_quantity();
+            expect(shared.get_quantity(name) == quantity, "ConcurrentInventory stock matches Inventory",
+                   shared.get_quantity(name) - quantity);
+        }
+    }
+
+    // checkout threads over a shared pool while restocks arrive
+    void runConcurrentCheckouts(int operations) {
+        constexpr int kThreads = 4;
+        constexpr int kItems = 48;
+        ConcurrentInventory shared;
+        std::vector<std::string> names;
+        for (int i = 0; i < kItems; i++) {
+            names.push_back("hot-" + std::to_string(i));
+            shared.add_item(names.back(), 200, static_cast<float>(i % 7 + 1));
+        }
+
+        std::vector<std::vector<int>> sold(kThreads, std::vector<int>(kItems, 0));
+        std::vector<double> earned(kThreads, 0.0);
+        std::vector<std::thread> checkouts;
+        for (int t = 0; t < kThreads; t++) {
+            const unsigned seed = static_cast<unsigned>(rng());
+            checkouts.emplace_back([&, t, seed] {
+                std::mt19937 local(seed);
+                for (int i = 0; i < operations / kThreads; i++) {
+                    std::vector<BundleLine> lines(local() % 3 + 1);
+                    std::vector<int> picked;
+                    for (BundleLine& line : lines) {
+                        picked.push_back(static_cast<int>(local() % kItems));
+                        line.name = names[static_cast<std::size_t>(picked.back())];
+                        line.quantity = static_cast<int>(local() % 3) + 1;
+                    }
+                    float money = 0;
+                    if (shared.sell_bundle(lines, &money) == SaleStatus::SOLD) {
+                        for (std::size_t l = 0; l < lines.size(); l++) {
+                            sold[t][static_cast<std::size_t>(picked[l])] += lines[l].quantity;
+                        }
+                        earned[t] += money;
+                    }
+                }
+            });
+        }
+        std::vector<int> restocked(kItems, 0);
+        for (int i = 0; i < operations / 20; i++) {
+            const int item = uniformInt(0, kItems - 1);
+            shared.add_item(names[static_cast<std::size_t>(item)], 5, static_cast<float>(item % 7 + 1));
+            restocked[static_cast<std::size_t>(item)] += 5;
+        }
+        for (std::thread& checkout : checkouts) {
+            checkout.join();
+        }
+
+        double money = 0;
+        for (int t = 0; t < kThreads; t++) {
+            money += earned[t];
+        }
+        for (int i = 0; i < kItems; i++) {
+            int taken = 0;
+            for (int t = 0; t < kThreads; t++) {
+                taken += sold[t][static_cast<std::size_t>(i)];
+            }
+            const int expected = 200 + restocked[static_cast<std::size_t>(i)] - taken;
+            expect(shared.get_quantity(names[static_cast<std::size_t>(i)]) == expected,
+                   "concurrent stock equals stock plus restocks minus sales", expected);
+        }
+        expect(shared.get_total_money() == static_cast<float>(money), "concurrent money equals the sales reported",
+               shared.get_total_money() - money);
+    }
+
+    // bundles per second from one thread, then from several over disjoint items
+    void measureConcurrentThroughput(int operations) {
+        const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (int threads : {1, 4}) {
+            ConcurrentInventory shared;
+            std::vector<std::vector<BundleLine>> bundles(static_cast<std::size_t>(threads));
+            for (int t = 0; t < threads; t++) {
+                for (int l = 0; l < 2; l++) {
+                    const std::string name = "own-" + std::to_string(t) + "-" + std::to_string(l);
+                    shared.add_item(name, 1 << 30, 1.0f);
+                    bundles[static_cast<std::size_t>(t)].push_back({name, 1});
+                }
+            }
+            const int per_thread = operations / threads;
+            const auto start = Clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] {
+                    for (int i = 0; i < per_thread; i++) {
+                        shared.sell_bundle(bundles[static_cast<std::size_t>(t)]);
+                    }
+                });
+            }
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::printf("concurrent bundles: %d thread(s) on %u hardware threads, %.0f bundles/s\n", threads,
+                        hardware, static_cast<double>(per_thread) * threads / seconds);
+        }
+    }
+
+    int report(bool strict) const {
+        std::printf("%-14s %10s %12s %12s %10s\n", "operation", "count", "over budget", "worst us", "at size");
+        bool slow = false;
+        for (int op = 0; op < OP_COUNT; op++) {
+            const OpStats& s = stats[op];
+            if (s.count == 0) {
+                continue;
+            }
+            std::printf("%-14s %10ld %12ld %12.1f %10zu%s\n", kOpNames[op], s.count, s.over_budget,
+                        s.worst_us, s.worst_size, s.over_budget > 0 ? "  SLOW" : "");
+            slow = slow || s.over_budget > 0;
+        }
+        MemoryAccounting::dump(stdout);
+        std::printf("%ld invariant checks, %zu failures\n", checks, failures.size());
+        for (const std::string& failure : failures) {
+            std::printf("  FAILED: %s\n", failure.c_str());
+        }
+        if (!failures.empty()) {
+            return 1;
+        }
+        return strict && slow ? 2 : 0;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool strict = argc > 1 && std::string(argv[1]) == "--strict";
+    if (strict) {
+        argc--;
+        argv++;
+    }
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1u;
+    const int operations = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const double budget_us = argc > 3 ? std::atof(argv[3]) : 1000.0;
+
+    std::printf("seed %u, %d operations per subsystem, budget %.1f us\n", seed, operations, budget_us);
+    StressHarness harness(seed, budget_us);
+    harness.runMomentum(operations);
+    harness.runInventory(operations);
+    harness.runConcurrentParity(operations);
+    harness.runConcurrentCheckouts(operations * 5);
+    harness.measureConcurrentThroughput(operations * 20);
+    return harness.report(strict);
+}